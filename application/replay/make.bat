@@ -0,0 +1,10 @@
+@echo off
+setlocal
+
+pushd %~dp0
+
+..\..\project\win_x64\make.bat source\unity.cpp
+
+popd
+
+exit /B %ERRORLEVEL%
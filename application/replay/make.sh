@@ -0,0 +1,11 @@
+#!/bin/bash
+
+pushd $(dirname $0) > /dev/null
+
+../../project/ubuntu/make.sh source/unity.cpp
+
+ReturnCode=$?
+
+popd > /dev/null
+
+exit $ReturnCode
@@ -0,0 +1,13 @@
+@echo off
+
+REM NOTE(hugo): run.bat <trace_file> [nrepetitions]
+
+set TracePath=%~f1
+
+pushd %~dp0\bin
+
+Application.exe %TracePath% %2
+
+popd
+
+exit /B %ERRORLEVEL%
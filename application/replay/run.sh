@@ -0,0 +1,15 @@
+#!/bin/bash
+
+# NOTE(hugo): ./run.sh <trace_file> [nrepetitions]
+
+TracePath=$(realpath $1)
+
+pushd $(dirname $0)/bin > /dev/null
+
+LSAN_OPTIONS=suppressions=../../../project/ubuntu/asan_suppress.supp ./Application $TracePath ${@:2}
+
+ReturnCode=$?
+
+popd > /dev/null
+
+exit $ReturnCode
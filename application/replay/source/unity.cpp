@@ -0,0 +1,301 @@
+#if defined(PLATFORM_LINUX) && defined(__GLIBC__)
+    #include <malloc.h>     // NOTE(hugo): malloc_trim
+#elif defined(PLATFORM_WINDOWS)
+    #include <psapi.h>      // NOTE(hugo): GetProcessMemoryInfo
+#endif
+
+using namespace bw;
+
+// NOTE(hugo): replays an allocation trace recorded with DEV_Memtracker_Trace_Start() against several allocators
+// usage : Application <trace_file> [nrepetitions]
+//
+// - throughput = events per second, measured without memory sampling ie a separate pass samples the resident memory
+// - peak resident = maximum increase of the process resident memory during the replay, sampled every replay_sample_period events
+// - overhead = 1 - peak live / peak resident ie the memory used by the allocator that is not requested by the trace
+//   the resident memory is sampled ie a lower bound that is only meaningful for traces larger than the allocator caches
+// the allocations are touched once per page such that the resident memory reflects the allocator layout
+
+constexpr u32 replay_sample_period = 1024u;
+constexpr size_t replay_touch_stride = 4096u;
+constexpr size_t replay_max_arena_bytesize = GIGABYTES(256u);
+
+struct Replay_Trace{
+    File_Mapping mapping;
+    const Memtrace_Header* header;
+    const Memtrace_Event* events;
+};
+
+struct Replay_Result{
+    double events_per_second;
+    size_t peak_resident_bytesize;
+    size_t peak_live_bytesize;
+};
+
+static size_t process_resident_bytesize(){
+#if defined(PLATFORM_LINUX)
+    FILE* file = fopen("/proc/self/statm", "r");
+    if(!file) return 0u;
+
+    unsigned long long total_pages = 0u;
+    unsigned long long resident_pages = 0u;
+    int nread = fscanf(file, "%llu %llu", &total_pages, &resident_pages);
+    fclose(file);
+
+    return nread == 2 ? (size_t)resident_pages * detect_pagesize() : 0u;
+#elif defined(PLATFORM_WINDOWS)
+    PROCESS_MEMORY_COUNTERS counters;
+    if(!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0u;
+    return counters.WorkingSetSize;
+#else
+    static_assert(false, "process_resident_bytesize() not implemented for this platform");
+#endif
+}
+
+static void touch_pages(void* ptr, size_t offset, size_t bytesize){
+    for(size_t ibyte = offset; ibyte < bytesize; ibyte += replay_touch_stride){
+        ((volatile u8*)ptr)[ibyte] = 1u;
+    }
+}
+
+static bool load_trace(const char* filename, Replay_Trace& trace){
+    File_Path path;
+    path = filename;
+
+    trace.mapping = map_file(path);
+    if(!trace.mapping.data) return false;
+
+    trace.header = (const Memtrace_Header*)trace.mapping.data;
+    trace.events = (const Memtrace_Event*)(trace.header + 1u);
+
+    if(trace.mapping.bytesize < sizeof(Memtrace_Header)
+    || trace.header->magic != memtrace_magic
+    || trace.header->version != memtrace_version
+    || trace.mapping.bytesize != sizeof(Memtrace_Header) + trace.header->nevents * sizeof(Memtrace_Event)){
+        LOG_ERROR("INVALID trace file %s", filename);
+        unmap_file(trace.mapping);
+        return false;
+    }
+
+    return true;
+}
+
+// ---- allocators
+
+// NOTE(hugo): report() is called after the memory pass, before destroy()
+
+struct Replay_Libc{
+    void create(const Replay_Trace&){}
+    void report(){}
+    void destroy(){
+#if defined(PLATFORM_LINUX) && defined(__GLIBC__)
+        malloc_trim(0u);
+#endif
+    }
+
+    void* allocate(size_t bytesize){
+        return ::malloc(bytesize);
+    }
+    void* reallocate(void* ptr, size_t, size_t bytesize){
+        return ::realloc(ptr, bytesize);
+    }
+    void free(void* ptr, size_t){
+        ::free(ptr);
+    }
+};
+
+// NOTE(hugo): upper bound for the fragmentation ie frees are ignored and reallocations always move
+struct Replay_Virtual_Arena{
+    void create(const Replay_Trace& trace){
+        size_t bytesize = 0u;
+        for(u64 ievent = 0u; ievent != trace.header->nevents; ++ievent){
+            bytesize += round_up_multiple((size_t)trace.events[ievent].bytesize, (size_t)16u);
+        }
+        arena.create(min(max(bytesize, (size_t)MEGABYTES(1u)), replay_max_arena_bytesize));
+    }
+    void report(){}
+    void destroy(){
+        arena.destroy();
+    }
+
+    void* allocate(size_t bytesize){
+        if(arena.cursor + bytesize + 16u > arena.vbytesize) return nullptr;
+        return arena.allocate(bytesize, 16u).ptr;
+    }
+    void* reallocate(void* ptr, size_t previous_bytesize, size_t bytesize){
+        void* output = allocate(bytesize);
+        if(output && ptr) memcpy(output, ptr, min(previous_bytesize, bytesize));
+        return output;
+    }
+    void free(void*, size_t){}
+
+    Virtual_Arena arena;
+};
+
+struct Replay_TLSF{
+    void create(const Replay_Trace&){
+        allocator.create();
+    }
+    void report(){
+        TLSF_Statistics stats = allocator.statistics();
+        printf("    fragmentation: %.3f - max allocate: %" PRIu64 " cycles - max free: %" PRIu64 " cycles\n",
+                stats.fragmentation, stats.max_allocation_cycles, stats.max_free_cycles);
+    }
+    void destroy(){
+        allocator.destroy();
+    }
+
+    void* allocate(size_t bytesize){
+        return allocator.allocate(bytesize);
+    }
+    void* reallocate(void* ptr, size_t, size_t bytesize){
+        return allocator.reallocate(ptr, bytesize);
+    }
+    void free(void* ptr, size_t){
+        allocator.free(ptr);
+    }
+
+    TLSF_Allocator allocator;
+};
+
+// ---- replay
+
+// NOTE(hugo): returns the duration in ticks ; sample_memory measures the resident memory instead
+template<typename Allocator>
+static u64 replay_pass(const Replay_Trace& trace, Allocator& allocator, void** pointers, u64* bytesizes, bool sample_memory, Replay_Result& result){
+    size_t base_resident = sample_memory ? process_resident_bytesize() : 0u;
+    size_t live_bytesize = 0u;
+    u32 nids = trace.header->nids;
+
+    u64 start = timer_ticks();
+
+    for(u64 ievent = 0u; ievent != trace.header->nevents; ++ievent){
+        const Memtrace_Event& event = trace.events[ievent];
+        if(event.id >= nids) continue;
+
+        void*& ptr = pointers[event.id];
+        u64& bytesize = bytesizes[event.id];
+
+        switch(event.type){
+            case Memtrace_Event_Type::Allocate:
+            case Memtrace_Event_Type::Callocate:
+            {
+                if(ptr) break;
+                ptr = allocator.allocate(event.bytesize);
+                if(!ptr) break;
+
+                if(event.type == Memtrace_Event_Type::Callocate) memset(ptr, 0, event.bytesize);
+                else touch_pages(ptr, 0u, event.bytesize);
+
+                bytesize = event.bytesize;
+                live_bytesize += bytesize;
+                break;
+            }
+            case Memtrace_Event_Type::Reallocate:
+            {
+                void* new_ptr = allocator.reallocate(ptr, bytesize, event.bytesize);
+                if(!new_ptr) break;
+
+                touch_pages(new_ptr, bytesize, event.bytesize);
+
+                live_bytesize = live_bytesize - bytesize + event.bytesize;
+                ptr = new_ptr;
+                bytesize = event.bytesize;
+                break;
+            }
+            case Memtrace_Event_Type::Free:
+            {
+                if(!ptr) break;
+                allocator.free(ptr, bytesize);
+
+                live_bytesize -= bytesize;
+                ptr = nullptr;
+                bytesize = 0u;
+                break;
+            }
+        }
+
+        if(sample_memory){
+            result.peak_live_bytesize = max(result.peak_live_bytesize, live_bytesize);
+            if(ievent % replay_sample_period == 0u){
+                size_t resident = process_resident_bytesize();
+                if(resident > base_resident) result.peak_resident_bytesize = max(result.peak_resident_bytesize, resident - base_resident);
+            }
+        }
+    }
+
+    u64 end = timer_ticks();
+
+    // NOTE(hugo): allocations still alive at the end of the trace
+    for(u32 iid = 0u; iid != nids; ++iid){
+        if(pointers[iid]) allocator.free(pointers[iid], bytesizes[iid]);
+    }
+    memset(pointers, 0, sizeof(void*) * nids);
+    memset(bytesizes, 0, sizeof(u64) * nids);
+
+    return end - start;
+}
+
+template<typename Allocator>
+static void replay(const char* name, const Replay_Trace& trace, u32 nrepetitions){
+    u32 nids = trace.header->nids;
+    void** pointers = (void**)::calloc(nids, sizeof(void*));
+    u64* bytesizes = (u64*)::calloc(nids, sizeof(u64));
+
+    Replay_Result result = {};
+
+    // NOTE(hugo): best of /nrepetitions/
+    u64 min_ticks = UINT64_MAX;
+    for(u32 irepetition = 0u; irepetition != nrepetitions; ++irepetition){
+        Allocator allocator;
+        allocator.create(trace);
+        min_ticks = min(min_ticks, replay_pass(trace, allocator, pointers, bytesizes, false, result));
+        allocator.destroy();
+    }
+
+    Allocator allocator;
+    allocator.create(trace);
+    replay_pass(trace, allocator, pointers, bytesizes, true, result);
+
+    double seconds = (double)min_ticks / (double)timer_frequency();
+    result.events_per_second = seconds > 0. ? (double)trace.header->nevents / seconds : 0.;
+
+    double overhead = result.peak_resident_bytesize > result.peak_live_bytesize ? 1. - (double)result.peak_live_bytesize / (double)result.peak_resident_bytesize : 0.;
+
+    printf("%-14s %16.0f %18" PRIu64 " %18" PRIu64 " %10.3f\n", name, result.events_per_second,
+            (u64)result.peak_resident_bytesize, (u64)result.peak_live_bytesize, overhead);
+
+    allocator.report();
+    allocator.destroy();
+
+    ::free(pointers);
+    ::free(bytesizes);
+}
+
+int main(int argc, char* argv[]){
+    if(argc < 2){
+        printf("usage: %s <trace_file> [nrepetitions]\n", argv[0]);
+        return 1;
+    }
+
+    setup_vmemory();
+    setup_timer();
+    setup_LOG();
+
+    Replay_Trace trace;
+    if(!load_trace(argv[1], trace)) return 1;
+
+    u32 nrepetitions = argc > 2 ? (u32)max(1, atoi(argv[2])) : 5u;
+
+    printf("-- %s: %" PRIu64 " events, %" PRIu32 " allocations, %" PRIu32 " repetitions\n",
+            argv[1], trace.header->nevents, trace.header->nids, nrepetitions);
+    printf("%-14s %16s %18s %18s %10s\n", "allocator", "events / s", "peak resident", "peak live", "overhead");
+
+    // NOTE(hugo): libc last since it may keep the memory of the previous replays resident
+    replay<Replay_Virtual_Arena>("Virtual_Arena", trace, nrepetitions);
+    replay<Replay_TLSF>("TLSF", trace, nrepetitions);
+    replay<Replay_Libc>("libc", trace, nrepetitions);
+
+    unmap_file(trace.mapping);
+
+    return 0;
+}
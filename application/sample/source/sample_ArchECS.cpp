@@ -27,14 +27,18 @@ struct ArchECS_Scene{
 
         drawer.create();
         entity_manager.create();
+        entity_manager.worker_pool = &get_engine().worker_pool;
 
-        system_draw = entity_manager.create_system<Transform, Shape_Disc>();
+        // NOTE(hugo): both systems stay serial ; ImDrawer and random_float() are not thread-safe
+        system_draw = entity_manager.create_system<archecs::Read<Transform>, archecs::Read<Shape_Disc>>();
         system_draw.data = (void*)this;
         system_draw.update = &system_draw_function;
+        entity_manager.create_query(system_draw);
 
         system_animate = entity_manager.create_system<Transform>();
         system_animate.data = (void*)this;
         system_animate.update = &system_animate_function;
+        entity_manager.create_query(system_animate);
 
         get_engine().action_manager.register_action(0u, KEYBOARD_SPACE);
     }
@@ -52,15 +56,24 @@ struct ArchECS_Scene{
             archecs::Archetype entity_archetype = entity_manager.create_archetype<Transform, Shape_Disc>();
 
             u32 nnew = 256u + random_u32_range_uniform(257u);
-            for(u32 inew = 0u; inew != nnew; ++inew){
-                archecs::Entity_Handle entity = entity_manager.create_entity(entity_archetype);
 
-                Transform* transform = entity_manager.get_data<Transform>(entity);
-                Shape_Disc* shape = entity_manager.get_data<Shape_Disc>(entity);
+            archecs::Entity_Handle* new_entities = (archecs::Entity_Handle*)bw_malloc(sizeof(archecs::Entity_Handle) * nnew);
+            DEFER{ bw_free(new_entities); };
+            array<archecs::Entity_Range> new_ranges;
+            new_ranges.create();
+            DEFER{ new_ranges.destroy(); };
 
-                (*shape).radius = 0.5f + random_float();
-                (*shape).color = rgba32(random_float(), random_float(), random_float(), 1.f);
-                (*transform).pos = {5.f + (random_float() - 0.5f) * (10.f - (*shape).radius), 5.f + (random_float() - 0.5f) * (10.f - (*shape).radius)};
+            entity_manager.create_entities(entity_archetype, nnew, new_entities, new_ranges);
+
+            for(auto& range : new_ranges){
+                Transform* transform = entity_manager.range_data<Transform>(range);
+                Shape_Disc* shape = entity_manager.range_data<Shape_Disc>(range);
+
+                for(u32 ientity = 0u; ientity != range.nentities; ++ientity){
+                    shape[ientity].radius = 0.5f + random_float();
+                    shape[ientity].color = rgba32(random_float(), random_float(), random_float(), 1.f);
+                    transform[ientity].pos = {5.f + (random_float() - 0.5f) * (10.f - shape[ientity].radius), 5.f + (random_float() - 0.5f) * (10.f - shape[ientity].radius)};
+                }
             }
             nentities = nentities + nnew;
         }
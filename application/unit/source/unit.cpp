@@ -4,6 +4,9 @@
 
 using namespace bw;
 
+#include "archecs.h"
+#include "archecs.cpp"
+
 namespace utest{
 
     constexpr float ftolerance = 0.000001f;
@@ -91,6 +94,40 @@ namespace utest{
 
         arena.destroy();
 
+        {
+            // NOTE(hugo): decommitted pages are no longer resident ; kept pages are
+            Virtual_Arena_Settings settings;
+            settings.keep_page_count = 2u;
+            arena.create(MEGABYTES(64u), settings);
+
+            Virtual_Arena_Memory mem = arena.allocate(MEGABYTES(4u), alignof(char));
+            memset(mem.ptr, 0xFF, MEGABYTES(4u));
+            success &= arena.committed_bytesize() == MEGABYTES(4u) && arena.resident_bytesize() == MEGABYTES(4u);
+
+            arena.free(mem);
+            arena.reset_to_cursor();
+            success &= arena.commit_page_count == 2u && arena.resident_bytesize() == 2u * BEEWAX_INTERNAL::vmemory_pagesize;
+
+            arena.reset();
+            success &= arena.commit_page_count == 2u && arena.cursor == 0u;
+
+            arena.destroy();
+        }
+
+        {
+            Virtual_Arena_Settings settings;
+            settings.huge_pages = true;
+            arena.create(MEGABYTES(3u), settings);
+            success &= ((uintptr_t)arena.vmemory % huge_page_bytesize) == 0u && arena.vbytesize == MEGABYTES(4u);
+
+            Virtual_Arena_Memory mem = arena.allocate(MEGABYTES(3u), alignof(char));
+            memset(mem.ptr, 0x00, MEGABYTES(3u));
+            arena.reset();
+            success &= arena.resident_bytesize() == 0u;
+
+            arena.destroy();
+        }
+
         if(!success){
             LOG_ERROR("FAILED utest::t_Virtual_Arena() - seed: %" PRId64 " %" PRId64, seed_copy.s0, seed_copy.s1);
             LOG_ERROR("FAILED utest::t_Virtual_Arena()");
@@ -99,6 +136,324 @@ namespace utest{
         }
     }
 
+    void t_Scratch_Scope(){
+        bool success = true;
+
+        Virtual_Arena& arena = get_scratch_arena();
+        size_t base_cursor = arena.cursor;
+
+        {
+            Scratch_Scope scratch;
+            u32* memA = scratch.allocate<u32>(1024u);
+            memset(memA, 0xFF, 1024u * sizeof(u32));
+            size_t outer_cursor = arena.cursor;
+
+            {
+                Scratch_Scope nested_scratch;
+                u64* memB = nested_scratch.allocate<u64>(4096u);
+                success &= memB && ((uintptr_t)memB % alignof(u64)) == 0u && arena.cursor > outer_cursor;
+                memset(memB, 0x00, 4096u * sizeof(u64));
+            }
+            success &= arena.cursor == outer_cursor && memA[1023u] == UINT32_MAX;
+
+            // NOTE(hugo): the memory of the nested scope is reused
+            size_t commit_page_count = arena.commit_page_count;
+            {
+                Scratch_Scope nested_scratch;
+                nested_scratch.allocate<u64>(4096u);
+                success &= arena.commit_page_count == commit_page_count;
+            }
+        }
+        success &= arena.cursor == base_cursor;
+
+        if(!success){
+            LOG_ERROR("FAILED utest::t_Scratch_Scope()");
+        }else{
+            LOG_INFO("FINISHED utest::t_Scratch_Scope()");
+        }
+    }
+
+    void t_Frame_Allocator(){
+        bool success = true;
+
+        Frame_Allocator allocator;
+        allocator.create(MEGABYTES(1u));
+
+        // NOTE(hugo): frame N
+        allocator.new_frame();
+        u32* frameN = allocator.allocate<u32>(256u);
+        for(u32 ivalue = 0u; ivalue != 256u; ++ivalue) frameN[ivalue] = ivalue;
+
+        // NOTE(hugo): frame N + 1 does not overwrite frame N
+        allocator.new_frame();
+        success &= allocator.last_frame_bytesize() == 256u * sizeof(u32);
+        u32* frameN1 = allocator.allocate<u32>(1024u);
+        memset(frameN1, 0xFF, 1024u * sizeof(u32));
+        for(u32 ivalue = 0u; ivalue != 256u; ++ivalue) success &= frameN[ivalue] == ivalue;
+
+        // NOTE(hugo): frame N + 2 reuses the memory of frame N
+        allocator.new_frame();
+        u32* frameN2 = allocator.allocate<u32>(16u);
+        success &= frameN2 == frameN;
+        success &= allocator.last_frame_bytesize() == 1024u * sizeof(u32);
+        success &= allocator.high_water_bytesize() == 1024u * sizeof(u32);
+
+        allocator.new_frame();
+        success &= allocator.last_frame_bytesize() == 16u * sizeof(u32);
+        success &= allocator.high_water_bytesize() == 1024u * sizeof(u32);
+
+        allocator.destroy();
+
+        if(!success){
+            LOG_ERROR("FAILED utest::t_Frame_Allocator()");
+        }else{
+            LOG_INFO("FINISHED utest::t_Frame_Allocator()");
+        }
+    }
+
+    void t_TLSF_Allocator(){
+        bool success = true;
+
+        constexpr u32 nslots = 512u;
+        constexpr u32 noperations = 100000u;
+
+        random_seed_with_time();
+        random_seed_type seed_copy = random_seed_copy();
+
+        TLSF_Allocator allocator;
+        allocator.create(GIGABYTES(1u));
+
+        // NOTE(hugo): each slot is filled with its index to detect overlapping blocks
+        u8* slots[nslots] = {};
+        u32 bytesizes[nslots] = {};
+
+        for(u32 ioperation = 0u; ioperation != noperations; ++ioperation){
+            u32 islot = random_u32_range_uniform(nslots);
+
+            if(slots[islot]){
+                for(u32 ibyte = 0u; ibyte != bytesizes[islot]; ++ibyte) success &= slots[islot][ibyte] == (u8)islot;
+            }
+
+            // NOTE(hugo): mostly small blocks with a few large ones
+            u32 bytesize = (random_u32() % 16u) ? random_u32_range_uniform(512u) + 1u : random_u32_range_uniform(KILOBYTES(256u)) + 1u;
+
+            switch(random_u32() % 3u){
+                default:
+                case 0:
+                    allocator.free(slots[islot]);
+                    slots[islot] = (u8*)allocator.allocate(bytesize);
+                    bytesizes[islot] = bytesize;
+                    break;
+                case 1:
+                    slots[islot] = (u8*)allocator.reallocate(slots[islot], bytesize);
+                    bytesizes[islot] = bytesize;
+                    break;
+                case 2:
+                    allocator.free(slots[islot]);
+                    slots[islot] = nullptr;
+                    bytesizes[islot] = 0u;
+                    break;
+            }
+
+            if(slots[islot]){
+                success &= ((uintptr_t)slots[islot] % tlsf_alignment) == 0u;
+                memset(slots[islot], (u8)islot, bytesizes[islot]);
+            }
+        }
+
+        TLSF_Statistics stats = allocator.statistics();
+        success &= stats.pool_bytesize > stats.used_bytesize + stats.free_bytesize;
+        success &= stats.largest_free_bytesize <= stats.free_bytesize;
+        success &= stats.fragmentation >= 0.f && stats.fragmentation <= 1.f;
+        success &= stats.nallocations != 0u && stats.max_allocation_cycles != 0u;
+
+        for(u32 islot = 0u; islot != nslots; ++islot){
+            allocator.free(slots[islot]);
+        }
+
+        // NOTE(hugo): free blocks are coalesced ie the pool is a single free block once everything is released
+        stats = allocator.statistics();
+        success &= stats.used_bytesize == 0u && stats.nused_blocks == 0u;
+        success &= stats.nfree_blocks == 1u && stats.fragmentation == 0.f;
+
+        allocator.destroy();
+
+        if(!success){
+            LOG_ERROR("FAILED utest::t_TLSF_Allocator() - seed: %" PRId64 " %" PRId64, seed_copy.s0, seed_copy.s1);
+        }else{
+            LOG_INFO("FINISHED utest::t_TLSF_Allocator()");
+        }
+    }
+
+    void t_Block_Pool(){
+        bool success = true;
+
+        // NOTE(hugo): cache line blocks
+        Block_Pool pool;
+        pool.create(40u, 100u, MEGABYTES(1u));
+        success &= pool.block_stride == cache_line_bytesize;
+        success &= pool.slab_bytesize % detect_pagesize() == 0u;
+
+        constexpr u32 nblocks = 1000u;
+        void* blocks[nblocks];
+        for(u32 iblock = 0u; iblock != nblocks; ++iblock){
+            blocks[iblock] = pool.allocate();
+            success &= ((uintptr_t)blocks[iblock] % cache_line_bytesize) == 0u;
+            memset(blocks[iblock], (int)iblock, 40u);
+        }
+        success &= pool.nallocated == nblocks;
+        u32 nslabs = pool.nslabs;
+        success &= nslabs == (nblocks + pool.blocks_per_slab - 1u) / pool.blocks_per_slab;
+
+        // NOTE(hugo): the last freed block is reused first
+        pool.free(blocks[10u]);
+        success &= pool.allocate() == blocks[10u];
+
+        // NOTE(hugo): only the empty slabs are released
+        for(u32 iblock = 0u; iblock != nblocks; ++iblock){
+            if(iblock != 0u) pool.free(blocks[iblock]);
+        }
+        success &= pool.nallocated == 1u;
+        success &= pool.release_empty_slabs(SIZE_MAX, 0u) == 0u;
+        success &= pool.release_empty_slabs(pool.slab_bytesize) == pool.slab_bytesize;
+        success &= pool.release_empty_slabs() == (nslabs - 2u) * pool.slab_bytesize;
+        success &= pool.committed_bytesize() == pool.slab_bytesize;
+        success &= pool.release_empty_slabs() == 0u;
+
+        // NOTE(hugo): released slabs are recommitted before appending new ones
+        for(u32 iblock = 1u; iblock != nblocks; ++iblock){
+            blocks[iblock] = pool.allocate();
+            success &= pool.contains(blocks[iblock]);
+            memset(blocks[iblock], 0xFF, 40u);
+        }
+        success &= pool.nslabs == nslabs;
+        success &= pool.nreleased_slabs == 0u;
+
+        pool.destroy();
+
+        // NOTE(hugo): page blocks
+        Block_Pool page_pool;
+        page_pool.create(KILOBYTES(16u), 4u, MEGABYTES(1u));
+        success &= page_pool.block_stride == KILOBYTES(16u);
+
+        u32 npage_blocks = 0u;
+        while(void* block = page_pool.allocate()){
+            success &= ((uintptr_t)block % detect_pagesize()) == 0u;
+            ++npage_blocks;
+        }
+        success &= npage_blocks == MEGABYTES(1u) / KILOBYTES(16u);
+
+        page_pool.destroy();
+
+        if(!success){
+            LOG_ERROR("FAILED utest::t_Block_Pool()");
+        }else{
+            LOG_INFO("FINISHED utest::t_Block_Pool()");
+        }
+    }
+
+    void t_memtracker(){
+#if defined(DEVELOPPER_MODE)
+        bool success = true;
+
+        BEEWAX_INTERNAL::Memtracker_Statistics before = BEEWAX_INTERNAL::memtracker_statistics();
+
+        void* A = bw_malloc(100u);
+        void* B = bw_calloc(4u, 25u);
+        A = bw_realloc(A, 300u);
+
+        BEEWAX_INTERNAL::Memtracker_Statistics during = BEEWAX_INTERNAL::memtracker_statistics();
+        success &= during.live_bytesize - before.live_bytesize == 400;
+        success &= during.live_count - before.live_count == 2;
+        success &= during.peak_bytesize >= before.live_bytesize + 400;
+        success &= during.nallocations - before.nallocations == 2u;
+        success &= during.nreallocations - before.nreallocations == 1u;
+
+        bw_free(A);
+        bw_free(B);
+
+        BEEWAX_INTERNAL::Memtracker_Statistics after = BEEWAX_INTERNAL::memtracker_statistics();
+        success &= after.live_bytesize == before.live_bytesize;
+        success &= after.live_count == before.live_count;
+
+        // NOTE(hugo): allocations per frame
+        BEEWAX_INTERNAL::memtracker_new_frame();
+        for(u32 iallocation = 0u; iallocation != 10u; ++iallocation){
+            bw_free(bw_malloc(16u));
+        }
+        BEEWAX_INTERNAL::memtracker_new_frame();
+
+        after = BEEWAX_INTERNAL::memtracker_statistics();
+        success &= after.last_frame_allocations == 10u;
+        success &= after.peak_frame_allocations >= 10u;
+
+        // NOTE(hugo): allocation trace
+        {
+            void* untraced = bw_malloc(8u);
+
+            success &= BEEWAX_INTERNAL::memtracker_trace_start("memtrace_utest.bin");
+            void* C = bw_malloc(32u);
+            C = bw_realloc(C, 64u);
+            untraced = bw_realloc(untraced, 16u);
+            bw_free(C);
+            bw_free(untraced);
+            BEEWAX_INTERNAL::memtracker_trace_stop();
+
+            File_Path path;
+            path = "memtrace_utest.bin";
+            File_Mapping mapping = map_file(path);
+            success &= mapping.data && mapping.bytesize == sizeof(Memtrace_Header) + 5u * sizeof(Memtrace_Event);
+
+            if(mapping.data){
+                Memtrace_Header* header = (Memtrace_Header*)mapping.data;
+                Memtrace_Event* events = (Memtrace_Event*)(header + 1u);
+
+                success &= header->magic == memtrace_magic && header->nevents == 5u;
+                success &= events[0u].type == Memtrace_Event_Type::Allocate && events[0u].bytesize == 32u;
+                success &= events[1u].type == Memtrace_Event_Type::Reallocate && events[1u].id == events[0u].id && events[1u].bytesize == 64u;
+                success &= events[2u].type == Memtrace_Event_Type::Allocate && events[2u].id != events[0u].id;
+                success &= events[3u].type == Memtrace_Event_Type::Free && events[3u].id == events[0u].id;
+                success &= events[4u].type == Memtrace_Event_Type::Free && events[4u].id == events[2u].id;
+                success &= events[4u].id < header->nids;
+
+                unmap_file(mapping);
+            }
+            remove("memtrace_utest.bin");
+
+            // NOTE(hugo): the ids restart with every trace ie an allocation of a previous trace appears as a new allocation
+            success &= BEEWAX_INTERNAL::memtracker_trace_start("memtrace_utest.bin");
+            void* survivor = bw_malloc(8u);
+            BEEWAX_INTERNAL::memtracker_trace_stop();
+
+            success &= BEEWAX_INTERNAL::memtracker_trace_start("memtrace_utest.bin");
+            survivor = bw_realloc(survivor, 16u);
+            bw_free(survivor);
+            BEEWAX_INTERNAL::memtracker_trace_stop();
+
+            mapping = map_file(path);
+            success &= mapping.data && mapping.bytesize == sizeof(Memtrace_Header) + 2u * sizeof(Memtrace_Event);
+
+            if(mapping.data){
+                Memtrace_Header* header = (Memtrace_Header*)mapping.data;
+                Memtrace_Event* events = (Memtrace_Event*)(header + 1u);
+
+                success &= header->nevents == 2u && header->nids == 2u;
+                success &= events[0u].type == Memtrace_Event_Type::Allocate && events[0u].id == 1u && events[0u].bytesize == 16u;
+                success &= events[1u].type == Memtrace_Event_Type::Free && events[1u].id == 1u;
+
+                unmap_file(mapping);
+            }
+            remove("memtrace_utest.bin");
+        }
+
+        if(!success){
+            LOG_ERROR("FAILED utest::t_memtracker()");
+        }else{
+            LOG_INFO("FINISHED utest::t_memtracker()");
+        }
+#endif
+    }
+
     void t_array(){
         bool success = true;
 
@@ -202,6 +557,303 @@ namespace utest{
         }
     }
 
+    void t_varray(){
+        bool success = true;
+
+        constexpr size_t max_capacity = 1u << 20u;
+        varray<u32> array;
+        array.create(max_capacity);
+        success &= (array.size == 0u && array.capacity == 0u);
+
+        // NOTE(hugo): the elements never move
+        u32* first = &array.push(0u);
+        for(u32 ivalue = 1u; ivalue != max_capacity; ++ivalue) array.push(ivalue);
+        success &= (array.data == first && array.size == max_capacity && array.capacity == max_capacity);
+        for(u32 ivalue = 0u; ivalue != max_capacity; ++ivalue) success &= array[ivalue] == ivalue;
+
+        array.remove_swap(0u);
+        success &= (array.size == max_capacity - 1u && array[0u] == max_capacity - 1u);
+        success &= array.pop() == max_capacity - 2u;
+
+        // NOTE(hugo): the pages after size are released and committed again on demand
+        array.resize(100u);
+        array.shrink();
+        success &= (array.capacity == 100u && array.arena.committed_bytesize() <= round_up_multiple(100u * sizeof(u32), detect_pagesize()));
+
+        array.reserve(200u);
+        success &= (array.capacity >= 200u && array.data == first && array[99u] == 99u);
+
+        u32 sum = 0u;
+        for(auto& value : array) sum += value;
+        success &= sum == (99u * 100u) / 2u + max_capacity - 1u;
+
+        array.clear();
+        success &= (array.size == 0u && array.data == first);
+
+        array.destroy();
+
+        if(!success){
+            LOG_ERROR("FAILED utest::t_varray()");
+        }else{
+            LOG_INFO("FINISHED utest::t_varray()");
+        }
+    }
+
+    void t_sbarray(){
+        bool success = true;
+
+        sbarray<s32, 4u> array;
+        array.create();
+        success &= (array.size == 0u && array.capacity == 4u && array.is_inline());
+        success &= array.data() == (s32*)array.inline_storage;
+
+        array.push(1);
+        array.push(2);
+        array.insert(1u, 3);
+        success &= (array.size == 3u && array.is_inline() && array[0u] == 1 && array[1u] == 3 && array[2u] == 2);
+
+        array.push(4);
+        success &= (array.size == 4u && array.is_inline());
+
+        // NOTE(hugo): spills to the heap past N
+        array.push(5);
+        success &= (array.size == 5u && !array.is_inline() && array.capacity > 4u);
+        success &= (array[0u] == 1 && array[1u] == 3 && array[2u] == 2 && array[3u] == 4 && array[4u] == 5);
+
+        array.insert_multi(1u, 2u);
+        array[1u] = 6;
+        array[2u] = 7;
+        success &= (array.size == 7u && array[0u] == 1 && array[1u] == 6 && array[2u] == 7 && array[3u] == 3);
+
+        array.remove(1u);
+        array.remove_multi(1u, 2u);
+        success &= (array.size == 4u && array[0u] == 1 && array[1u] == 2 && array[2u] == 4 && array[3u] == 5);
+
+        array.remove_swap(0u);
+        success &= (array.size == 3u && array[0u] == 5 && array.pop() == 4);
+
+        s32 sum = 0;
+        for(auto& value : array) sum += value;
+        success &= sum == 7;
+
+        // NOTE(hugo): the heap memory is kept
+        size_t capacity = array.capacity;
+        array.clear();
+        success &= (array.size == 0u && array.capacity == capacity && !array.is_inline());
+
+        array.resize(100u);
+        success &= (array.size == 100u && array.capacity >= 100u);
+        array.destroy();
+
+        sbarray<u64, 8u> reserved;
+        reserved.create();
+        reserved.reserve(8u);
+        success &= reserved.is_inline();
+        reserved.reserve(9u);
+        success &= (!reserved.is_inline() && reserved.capacity >= 9u);
+        reserved.destroy();
+
+        if(!success){
+            LOG_ERROR("FAILED utest::t_sbarray()");
+        }else{
+            LOG_INFO("FINISHED utest::t_sbarray()");
+        }
+    }
+
+    void t_hashmap(){
+        bool success = true;
+
+        constexpr u32 nkeys = 4096u;
+        constexpr u32 noperations = 200000u;
+
+        random_seed_with_time();
+        random_seed_type seed_copy = random_seed_copy();
+
+        // NOTE(hugo): reference values ; -1 when the key is not in the map
+        s32 reference[nkeys];
+        memset(reference, 0xFF, sizeof(reference));
+        u32 nreference = 0u;
+
+        hashmap<u32, s32> map;
+        map.create();
+
+        // NOTE(hugo): the keys are multiples of 64 ie hashes that only differ in the high bits
+        for(u32 ioperation = 0u; ioperation != noperations; ++ioperation){
+            u32 ikey = random_u32_range_uniform(nkeys);
+            u32 key = ikey * 64u;
+            s32* value;
+
+            switch(random_u32() % 3u){
+                case 0u:
+                {
+                    u32 created = map.get(key, value);
+                    success &= created == (reference[ikey] == -1 ? 1u : 0u);
+                    if(!created) success &= *value == reference[ikey];
+                    else ++nreference;
+                    *value = (s32)ioperation;
+                    reference[ikey] = (s32)ioperation;
+                    break;
+                }
+                case 1u:
+                {
+                    u32 found = map.search(key, value);
+                    success &= found == (reference[ikey] != -1 ? 1u : 0u);
+                    if(found) success &= *value == reference[ikey];
+                    break;
+                }
+                default:
+                {
+                    u32 removed = map.remove(key);
+                    success &= removed == (reference[ikey] != -1 ? 1u : 0u);
+                    if(removed) --nreference;
+                    reference[ikey] = -1;
+                    break;
+                }
+            }
+        }
+        success &= map.size() == nreference;
+
+        u32 niterated = 0u;
+        for(auto& entry : map){
+            success &= (entry.key() % 64u == 0u && reference[entry.key() / 64u] == entry.value());
+            ++niterated;
+        }
+        success &= niterated == nreference;
+
+        // NOTE(hugo): every key including the missing ones ; the count is not a multiple of the batch size
+        u32* keys = (u32*)bw_malloc(sizeof(u32) * (nkeys + 5u));
+        s32** values = (s32**)bw_malloc(sizeof(s32*) * (nkeys + 5u));
+        for(u32 ikey = 0u; ikey != nkeys + 5u; ++ikey) keys[ikey] = ikey * 64u;
+        u32 nfound = map.search_many(keys, nkeys + 5u, values);
+        success &= nfound == nreference;
+        for(u32 ikey = 0u; ikey != nkeys + 5u; ++ikey){
+            s32 expected = ikey < nkeys ? reference[ikey] : -1;
+            success &= expected == -1 ? values[ikey] == nullptr : (values[ikey] && *values[ikey] == expected);
+        }
+        bw_free(keys);
+        bw_free(values);
+
+        // NOTE(hugo): reserve fits the keys without rehashing
+        map.clear();
+        success &= (map.size() == 0u && map.begin().index == map.end().index);
+        map.reserve(10000u);
+        size_t capacity = map.capacity();
+        for(u32 ikey = 0u; ikey != 10000u; ++ikey){
+            s32* value;
+            map.get(ikey, value);
+            *value = (s32)ikey;
+        }
+        success &= map.capacity() == capacity;
+
+        map.destroy();
+
+        if(!success){
+            LOG_ERROR("FAILED utest::t_hashmap() - seed: %" PRId64 " %" PRId64, seed_copy.s0, seed_copy.s1);
+        }else{
+            LOG_INFO("FINISHED utest::t_hashmap()");
+        }
+    }
+
+    void t_allocator_policy(){
+        bool success = true;
+
+        Virtual_Arena arena;
+        arena.create(MEGABYTES(64u));
+        Arena_Allocator arena_allocator = {&arena};
+
+        // NOTE(hugo): the last allocation of the arena grows in place
+        array<u32, Arena_Allocator> values;
+        values.create(arena_allocator);
+        values.push(0u);
+        u32* first = values.data;
+        for(u32 ivalue = 1u; ivalue != 10000u; ++ivalue) values.push(ivalue);
+        success &= values.data == first;
+        for(u32 ivalue = 0u; ivalue != 10000u; ++ivalue) success &= values[ivalue] == ivalue;
+
+        hashmap<u32, u32, Arena_Allocator> map;
+        map.create(arena_allocator);
+        for(u32 ikey = 0u; ikey != 10000u; ++ikey){
+            u32* value;
+            success &= map.get(ikey * 7u, value) == 1u;
+            *value = ikey;
+        }
+        for(u32 ikey = 0u; ikey != 10000u; ++ikey){
+            u32* value;
+            success &= (map.search(ikey * 7u, value) == 1u && *value == ikey);
+        }
+        success &= map.remove(7u) == 1u;
+        success &= map.size() == 9999u;
+
+        // NOTE(hugo): moved when not the last allocation
+        values.reserve(values.capacity + 1u);
+        success &= (values.data != first && values[0u] == 0u && values[9999u] == 9999u);
+
+        // NOTE(hugo): the containers are dropped with the arena
+        success &= arena.cursor != 0u;
+        arena.reset();
+        arena.destroy();
+
+        // NOTE(hugo): valid until the next frame of the frame allocator
+        Frame_Allocator frame_allocator;
+        frame_allocator.create(MEGABYTES(1u));
+        frame_allocator.new_frame();
+
+        array<vec2, Frame_Arena_Allocator> points;
+        points.create({&frame_allocator});
+        for(u32 ipoint = 0u; ipoint != 1000u; ++ipoint) points.push({(float)ipoint, 0.f});
+        success &= (points.size == 1000u && points[999u].x == 999.f);
+        success &= frame_allocator.regions[frame_allocator.current_region].cursor >= 1000u * sizeof(vec2);
+
+        frame_allocator.destroy();
+
+        if(!success){
+            LOG_ERROR("FAILED utest::t_allocator_policy()");
+        }else{
+            LOG_INFO("FINISHED utest::t_allocator_policy()");
+        }
+    }
+
+    void t_string_id(){
+        bool success = true;
+
+        // NOTE(hugo): FNV1a 64 bits reference values
+        static_assert(string_id_hash("", 0u) == 0xcbf29ce484222325u);
+        static_assert(string_id_hash("a", 1u) == 0xaf63dc4c8601ec8cu);
+        static_assert(string_id_hash("foobar", 6u) == 0x85944171f73967e8u);
+
+        // NOTE(hugo): the table may already contain strings
+        u32 base = string_table_size();
+
+        constexpr u32 nstrings = 1000u;
+        String_ID ids[nstrings];
+        char buffer[32u];
+        for(u32 istring = 0u; istring != nstrings; ++istring){
+            snprintf(buffer, sizeof(buffer), "utest_string_%u", istring);
+            ids[istring] = string_id(buffer);
+            success &= ids[istring] == base + istring;
+        }
+        success &= string_table_size() == base + nstrings;
+
+        for(u32 istring = 0u; istring != nstrings; ++istring){
+            snprintf(buffer, sizeof(buffer), "utest_string_%u", istring);
+            success &= string_id(buffer) == ids[istring];
+            success &= search_string_id(buffer) == ids[istring];
+            success &= strcmp(string_id_cstring(ids[istring]), buffer) == 0;
+            success &= string_id_strlen(ids[istring]) == strlen(buffer);
+        }
+        success &= string_table_size() == base + nstrings;
+
+        success &= STRING_ID("utest_string_7") == ids[7u];
+        success &= string_id("utest_string_42_suffix", 15u) == ids[42u];
+        success &= search_string_id("utest_string_missing") == invalid_string_id;
+
+        if(!success){
+            LOG_ERROR("FAILED utest::t_string_id()");
+        }else{
+            LOG_INFO("FINISHED utest::t_string_id()");
+        }
+    }
+
     void t_dhashmap(){
         bool success = true;
 
@@ -470,6 +1122,108 @@ namespace utest{
         }
     }
 
+    // NOTE(hugo): compared with qsort ; duplicates, sorted and reversed inputs are the worst cases of a naive quicksort
+    void t_introsort(){
+        bool success = true;
+
+        constexpr u32 max_size = 5000u;
+
+        random_seed_with_time();
+        random_seed_type seed_copy = random_seed_copy();
+
+        s32* array_introsort = (s32*)bw_malloc(sizeof(s32) * max_size);
+        s32* array_qsort = (s32*)bw_malloc(sizeof(s32) * max_size);
+
+        u32 sizes[] = {0u, 1u, 2u, 3u, 15u, 16u, 17u, 100u, max_size};
+        for(u32 size : sizes){
+            for(u32 ipattern = 0u; ipattern != 4u; ++ipattern){
+                for(u32 inumber = 0u; inumber != size; ++inumber){
+                    switch(ipattern){
+                        case 0u: array_introsort[inumber] = random_s32();                   break;
+                        case 1u: array_introsort[inumber] = (s32)random_u32_range_uniform(4u); break;
+                        case 2u: array_introsort[inumber] = (s32)inumber;                   break;
+                        case 3u: array_introsort[inumber] = - (s32)inumber;                 break;
+                    }
+                }
+                if(size) memcpy(array_qsort, array_introsort, sizeof(s32) * size);
+
+                introsort(array_introsort, size);
+                qsort(array_qsort, size);
+                success &= size == 0u || memcmp(array_introsort, array_qsort, sizeof(s32) * size) == 0;
+
+                introsort<s32, &comparison_decreasing_order>(array_introsort, size);
+                for(u32 inumber = 1u; inumber < size; ++inumber){
+                    success &= array_introsort[inumber - 1u] >= array_introsort[inumber];
+                }
+            }
+        }
+
+        bw_free(array_introsort);
+        bw_free(array_qsort);
+
+        if(!success){
+            LOG_ERROR("FAILED utest::t_introsort() - seed: %" PRId64 " %" PRId64, seed_copy.s0, seed_copy.s1);
+        }else{
+            LOG_INFO("FINISHED utest::t_introsort()");
+        }
+    }
+
+    struct Radix_Sort_Element{
+        float depth;
+        u32 index;
+    };
+    static float radix_sort_element_depth(const Radix_Sort_Element& element){
+        return element.depth;
+    }
+
+    void t_radix_sort(){
+        bool success = true;
+
+        constexpr u32 size = 10000u;
+
+        random_seed_with_time();
+        random_seed_type seed_copy = random_seed_copy();
+
+        s32* array_s32 = (s32*)bw_malloc(sizeof(s32) * size);
+        s64* array_s64 = (s64*)bw_malloc(sizeof(s64) * size);
+        Radix_Sort_Element* elements = (Radix_Sort_Element*)bw_malloc(sizeof(Radix_Sort_Element) * size);
+
+        for(u32 inumber = 0u; inumber != size; ++inumber){
+            array_s32[inumber] = random_s32();
+            array_s64[inumber] = (s64)array_s32[inumber] * (s64)random_u32();
+        }
+        radix_sort(array_s32, size);
+        radix_sort(array_s64, size);
+        for(u32 inumber = 1u; inumber != size; ++inumber){
+            success &= array_s32[inumber - 1u] <= array_s32[inumber];
+            success &= array_s64[inumber - 1u] <= array_s64[inumber];
+        }
+
+        // NOTE(hugo): a few depths for many elements ie the order of the indices checks the stability
+        float depths[] = {-2.5f, 0.f, 1.f, 1e-30f, -1e30f, 3.f};
+        for(u32 ielement = 0u; ielement != size; ++ielement){
+            elements[ielement].depth = depths[random_u32_range_uniform((u32)carray_size(depths))];
+            elements[ielement].index = ielement;
+        }
+        radix_sort<Radix_Sort_Element, float, &radix_sort_element_depth>(elements, size);
+        for(u32 ielement = 1u; ielement != size; ++ielement){
+            const Radix_Sort_Element& previous = elements[ielement - 1u];
+            const Radix_Sort_Element& current = elements[ielement];
+            success &= previous.depth <= current.depth;
+            success &= previous.depth != current.depth || previous.index < current.index;
+        }
+
+        bw_free(array_s32);
+        bw_free(array_s64);
+        bw_free(elements);
+
+        if(!success){
+            LOG_ERROR("FAILED utest::t_radix_sort() - seed: %" PRId64 " %" PRId64, seed_copy.s0, seed_copy.s1);
+        }else{
+            LOG_INFO("FINISHED utest::t_radix_sort()");
+        }
+    }
+
     void t_binsearch(){
         bool success = true;
 
@@ -921,6 +1675,364 @@ namespace utest{
         LOG_INFO("triangulation_2D_v1: %" PRId64, timer_end - timer_v1);
     }
 
+    // NOTE(hugo): short-lived lists of /nelements/ elements
+    void t_compare_sbarray(){
+        constexpr u32 nrun = 1000000u;
+
+        u32 nelements_list[] = {4u, 8u, 16u};
+        for(u32 nelements : nelements_list){
+            u64 checksum = 0u;
+
+            u64 timer_array = timer_ticks();
+
+            for(u32 irun = 0u; irun != nrun; ++irun){
+                array<u32> list;
+                list.create();
+                for(u32 ielement = 0u; ielement != nelements; ++ielement) list.push(irun + ielement);
+                for(auto& element : list) checksum += element;
+                list.destroy();
+            }
+
+            u64 timer_sbarray = timer_ticks();
+
+            for(u32 irun = 0u; irun != nrun; ++irun){
+                sbarray<u32, 8u> list;
+                list.create();
+                for(u32 ielement = 0u; ielement != nelements; ++ielement) list.push(irun + ielement);
+                for(auto& element : list) checksum += element;
+                list.destroy();
+            }
+
+            u64 timer_end = timer_ticks();
+
+            LOG_INFO("nelements: %u array: %" PRId64 " sbarray<8>: %" PRId64 " checksum: %" PRIu64,
+                    nelements, timer_sbarray - timer_array, timer_end - timer_sbarray, checksum);
+        }
+    }
+
+    static s32 compare_radix_sort_element_depth(const Radix_Sort_Element& A, const Radix_Sort_Element& B){
+        return comparison_increasing_order(A.depth, B.depth);
+    }
+
+    // NOTE(hugo): s32 values and 8 bytes structs sorted by a float key ie archetype IDs and particles by depth
+    void t_compare_sort(){
+        constexpr u32 max_size = 1000000u;
+        constexpr u32 nrepetitions = 5u;
+
+        s32* values = (s32*)bw_malloc(sizeof(s32) * max_size);
+        s32* sorted = (s32*)bw_malloc(sizeof(s32) * max_size);
+        Radix_Sort_Element* elements = (Radix_Sort_Element*)bw_malloc(sizeof(Radix_Sort_Element) * max_size);
+        Radix_Sort_Element* sorted_elements = (Radix_Sort_Element*)bw_malloc(sizeof(Radix_Sort_Element) * max_size);
+
+        for(u32 ivalue = 0u; ivalue != max_size; ++ivalue){
+            values[ivalue] = random_s32();
+            elements[ivalue] = {random_float() * 200.f - 100.f, ivalue};
+        }
+
+        double ns_per_tick = 1e9 / (double)timer_frequency();
+
+        // NOTE(hugo): best of /nrepetitions/ in ns per element
+        auto measure = [&](auto sort, auto* source, auto* destination, u32 size){
+            u64 min_ticks = UINT64_MAX;
+            for(u32 irepetition = 0u; irepetition != nrepetitions; ++irepetition){
+                memcpy(destination, source, sizeof(*source) * size);
+                u64 timer_start = timer_ticks();
+                sort(destination, size);
+                min_ticks = min(min_ticks, timer_ticks() - timer_start);
+            }
+            return (double)min_ticks * ns_per_tick / (double)size;
+        };
+
+        u32 sizes[] = {1000u, 10000u, 100000u, 1000000u};
+        for(u32 size : sizes){
+            double s32_qsort = measure([](s32* data, u32 nvalues){ qsort(data, nvalues); }, values, sorted, size);
+            double s32_introsort = measure([](s32* data, u32 nvalues){ introsort(data, nvalues); }, values, sorted, size);
+            double s32_radix_sort = measure([](s32* data, u32 nvalues){ radix_sort(data, nvalues); }, values, sorted, size);
+
+            double depth_qsort = measure([](Radix_Sort_Element* data, u32 nvalues){
+                qsort<Radix_Sort_Element, &compare_radix_sort_element_depth>(data, nvalues);
+            }, elements, sorted_elements, size);
+            double depth_introsort = measure([](Radix_Sort_Element* data, u32 nvalues){
+                introsort<Radix_Sort_Element, &compare_radix_sort_element_depth>(data, nvalues);
+            }, elements, sorted_elements, size);
+            double depth_radix_sort = measure([](Radix_Sort_Element* data, u32 nvalues){
+                radix_sort<Radix_Sort_Element, float, &radix_sort_element_depth>(data, nvalues);
+            }, elements, sorted_elements, size);
+
+            LOG_INFO("size: %7u ns/element s32 qsort: %5.1f introsort: %5.1f radix_sort: %5.1f - depth qsort: %5.1f introsort: %5.1f radix_sort: %5.1f",
+                    size, s32_qsort, s32_introsort, s32_radix_sort, depth_qsort, depth_introsort, depth_radix_sort);
+        }
+
+        bw_free(values);
+        bw_free(sorted);
+        bw_free(elements);
+        bw_free(sorted_elements);
+    }
+
+    // NOTE(hugo): the hash of each key is fed to the next one ie measures the latency of dependent hashes
+    void t_compare_hash(){
+        constexpr u32 nbytes_max = 1024u;
+        constexpr u32 ntotal_bytes = 1u << 28u;
+
+        u8 buffer[nbytes_max + sizeof(u32)];
+        for(u32 ibyte = 0u; ibyte != nbytes_max + sizeof(u32); ++ibyte) buffer[ibyte] = (u8)random_u32();
+
+        double ns_per_tick = 1e9 / (double)timer_frequency();
+
+        u32 nbytes_list[] = {4u, 8u, 16u, 32u, 64u, 128u, 255u, 1024u};
+        for(u32 nbytes : nbytes_list){
+            u32 nrun = ntotal_bytes / nbytes;
+            u64 checksum = 0u;
+
+            u64 timer_FNV1a = timer_ticks();
+
+            for(u32 irun = 0u; irun != nrun; ++irun){
+                u32 hash = hash_FNV1a_32ptr(buffer, nbytes);
+                memcpy(buffer, &hash, sizeof(u32));
+                checksum += hash;
+            }
+
+            u64 timer_wyhash = timer_ticks();
+
+            for(u32 irun = 0u; irun != nrun; ++irun){
+                u32 hash = (u32)hash_wyhash(buffer, nbytes);
+                memcpy(buffer, &hash, sizeof(u32));
+                checksum += hash;
+            }
+
+            u64 timer_end = timer_ticks();
+
+            auto GBps = [&](u64 ticks){
+                return (double)nrun * (double)nbytes / ((double)ticks * ns_per_tick);
+            };
+            LOG_INFO("nbytes: %4u GB/s FNV1a: %6.2f wyhash: %6.2f checksum: %" PRIu64,
+                    nbytes, GBps(timer_wyhash - timer_FNV1a), GBps(timer_end - timer_wyhash), checksum);
+        }
+    }
+
+    // NOTE(hugo): /keys/ in random order ; /missing_keys/ were never inserted
+    template<typename Map, typename Key>
+    static void compare_hashmap_run(const char* name, const Key* keys, const Key* missing_keys, u32 nkeys){
+        u64 checksum = 0u;
+
+        Map map;
+        map.create();
+
+        u64 timer_insert = timer_ticks();
+
+        for(u32 ikey = 0u; ikey != nkeys; ++ikey){
+            u32* value;
+            map.get(keys[ikey], value);
+            *value = ikey;
+        }
+
+        u64 timer_hit = timer_ticks();
+
+        for(u32 ikey = 0u; ikey != nkeys; ++ikey){
+            u32* value;
+            if(map.search(keys[ikey], value)) checksum += *value;
+        }
+
+        u64 timer_miss = timer_ticks();
+
+        for(u32 ikey = 0u; ikey != nkeys; ++ikey){
+            u32* value;
+            checksum += map.search(missing_keys[ikey], value);
+        }
+
+        u64 timer_remove = timer_ticks();
+
+        for(u32 ikey = 0u; ikey != nkeys; ++ikey){
+            checksum += map.remove(keys[ikey]);
+        }
+
+        u64 timer_end = timer_ticks();
+
+        map.destroy();
+
+        double ns_per_tick = 1e9 / (double)timer_frequency();
+        LOG_INFO("%-22s nkeys: %8u ns/op insert: %6.1f search hit: %6.1f search miss: %6.1f remove: %6.1f checksum: %" PRIu64, name, nkeys,
+                (double)(timer_hit - timer_insert) * ns_per_tick / nkeys,
+                (double)(timer_miss - timer_hit) * ns_per_tick / nkeys,
+                (double)(timer_remove - timer_miss) * ns_per_tick / nkeys,
+                (double)(timer_end - timer_remove) * ns_per_tick / nkeys,
+                checksum);
+    }
+
+    // NOTE(hugo): one query in two is a hit ; the queries are resolved in groups of /nqueries_per_call/ as a system would
+    void t_compare_hashmap_search_many(){
+        constexpr u32 nqueries = 1u << 22u;
+        constexpr u32 nqueries_per_call = 1024u;
+        constexpr u32 nrepetitions = 5u;
+
+        u32* queries = (u32*)bw_malloc(sizeof(u32) * nqueries);
+        u32** values = (u32**)bw_malloc(sizeof(u32*) * nqueries_per_call);
+
+        double ns_per_tick = 1e9 / (double)timer_frequency();
+
+        // NOTE(hugo): 16K keys fit in L2 ; the others do not
+        u32 nkeys_list[] = {1u << 14u, 1u << 20u, 1u << 23u};
+        for(u32 nkeys : nkeys_list){
+            hashmap<u32, u32> map;
+            map.create();
+            for(u32 ikey = 0u; ikey != nkeys; ++ikey){
+                u32* value;
+                map.get(hash_wang(ikey) * 2u, value);
+                *value = ikey;
+            }
+
+            for(u32 iquery = 0u; iquery != nqueries; ++iquery){
+                u32 ikey = random_u32_range_uniform(nkeys);
+                queries[iquery] = hash_wang(ikey) * 2u + (iquery & 1u);
+            }
+
+            u64 checksum_search = 0u;
+            u64 checksum_search_many = 0u;
+
+            // NOTE(hugo): best of /nrepetitions/
+            u64 ticks_search = UINT64_MAX;
+            u64 ticks_search_many = UINT64_MAX;
+            for(u32 irepetition = 0u; irepetition != nrepetitions; ++irepetition){
+                u64 timer_search = timer_ticks();
+
+                for(u32 iquery = 0u; iquery != nqueries; ++iquery){
+                    u32* value;
+                    if(map.search(queries[iquery], value)) checksum_search += *value;
+                }
+
+                u64 timer_search_many = timer_ticks();
+
+                for(u32 iquery = 0u; iquery != nqueries; iquery += nqueries_per_call){
+                    map.search_many(queries + iquery, nqueries_per_call, values);
+                    for(u32 ivalue = 0u; ivalue != nqueries_per_call; ++ivalue){
+                        if(values[ivalue]) checksum_search_many += *values[ivalue];
+                    }
+                }
+
+                u64 timer_end = timer_ticks();
+
+                ticks_search = min(ticks_search, timer_search_many - timer_search);
+                ticks_search_many = min(ticks_search_many, timer_end - timer_search_many);
+            }
+
+            LOG_INFO("nkeys: %8u ns/query search: %6.1f search_many: %6.1f checksum: %s",
+                    nkeys,
+                    (double)ticks_search * ns_per_tick / (double)nqueries,
+                    (double)ticks_search_many * ns_per_tick / (double)nqueries,
+                    checksum_search == checksum_search_many ? "ok" : "MISMATCH");
+
+            map.destroy();
+        }
+
+        bw_free(queries);
+        bw_free(values);
+    }
+
+    void t_compare_hashmap(){
+        random_seed_with_time();
+
+        u32 nkeys_list[] = {1000u, 100000u, 1000000u};
+        for(u32 nkeys : nkeys_list){
+            u32* permutation = random_permutation(nkeys);
+
+            // NOTE(hugo): even keys are inserted and odd keys are missing
+            u32* keys = (u32*)bw_malloc(sizeof(u32) * nkeys);
+            u32* missing_keys = (u32*)bw_malloc(sizeof(u32) * nkeys);
+            for(u32 ikey = 0u; ikey != nkeys; ++ikey){
+                keys[ikey] = permutation[ikey] * 2u;
+                missing_keys[ikey] = permutation[ikey] * 2u + 1u;
+            }
+
+            compare_hashmap_run<hashmap<u32, u32>>("hashmap<u32>", keys, missing_keys, nkeys);
+            compare_hashmap_run<khashmap<u32, u32>>("khashmap<u32>", keys, missing_keys, nkeys);
+
+            bw_free(keys);
+            bw_free(missing_keys);
+
+            if(nkeys <= 100000u){
+                Asset_Name* names = (Asset_Name*)bw_malloc(sizeof(Asset_Name) * nkeys);
+                Asset_Name* missing_names = (Asset_Name*)bw_malloc(sizeof(Asset_Name) * nkeys);
+                char buffer[Asset_Name::strcap() + 1u];
+                for(u32 ikey = 0u; ikey != nkeys; ++ikey){
+                    snprintf(buffer, sizeof(buffer), "data/texture/asset_%u.png", permutation[ikey] * 2u);
+                    names[ikey] = buffer;
+                    snprintf(buffer, sizeof(buffer), "data/texture/asset_%u.png", permutation[ikey] * 2u + 1u);
+                    missing_names[ikey] = buffer;
+                }
+
+                compare_hashmap_run<hashmap<Asset_Name, u32>>("hashmap<Asset_Name>", names, missing_names, nkeys);
+                compare_hashmap_run<khashmap<Asset_Name, u32>>("khashmap<Asset_Name>", names, missing_names, nkeys);
+
+                bw_free(names);
+                bw_free(missing_names);
+            }
+
+            bw_free(permutation);
+        }
+    }
+
+    template<u32 index>
+    struct Bench_Component{
+        u32 data[1u + index];
+    };
+
+    void t_archecs_archetype_lookup(){
+        using Bench_Manager = archecs::Entity_Manager<
+            Bench_Component<0u>, Bench_Component<1u>, Bench_Component<2u>, Bench_Component<3u>, Bench_Component<4u>,
+            Bench_Component<5u>, Bench_Component<6u>, Bench_Component<7u>, Bench_Component<8u>, Bench_Component<9u>>;
+        constexpr u32 ncomponents = 10u;
+        constexpr u32 nops = 100000u;
+
+        u32 narchetypes_runs[] = {16u, 64u, 256u, 1024u};
+
+        for(u32 irun = 0u; irun != carray_size(narchetypes_runs); ++irun){
+            u32 narchetypes = narchetypes_runs[irun];
+
+            Bench_Manager manager;
+            manager.create();
+
+            // NOTE(hugo): one archetype per subset of components ; type_ID 0 is Entity_Handle
+            array<archecs::Archetype> archetypes;
+            array<archecs::Entity_Handle> entities;
+            archetypes.create();
+            entities.create();
+
+            for(u32 iarch = 0u; iarch != narchetypes; ++iarch){
+                archecs::Archetype archetype = manager.create_archetype();
+                for(u32 icomp = 0u; icomp != ncomponents; ++icomp){
+                    if(iarch & (1u << icomp)) archecs::add_type(manager.ecs_manager, manager.type_metadata, archetype, 1u + icomp);
+                }
+                archetypes.push(archetype);
+                entities.push(manager.create_entity(archetype));
+            }
+
+            u64 timer_create = timer_ticks();
+
+            for(u32 iop = 0u; iop != nops; ++iop){
+                entities.push(manager.create_entity(archetypes[iop % narchetypes]));
+            }
+
+            u64 timer_transition = timer_ticks();
+
+            for(u32 iop = 0u; iop != nops; ++iop){
+                archecs::Entity_Handle entity = entities[iop % narchetypes];
+                manager.attach_data<Bench_Component<9u>>(entity);
+                manager.detach_data<Bench_Component<9u>>(entity);
+            }
+
+            u64 timer_end = timer_ticks();
+
+            LOG_INFO("archecs narchetypes: %u create_entity: %" PRId64 " attach + detach: %" PRId64,
+                    narchetypes, (timer_transition - timer_create) / nops, (timer_end - timer_transition) / nops);
+
+            for(auto& entity : entities) manager.destroy_entity(entity);
+            entities.destroy();
+            archetypes.destroy();
+
+            manager.destroy();
+        }
+    }
+
     void run(){
         SDL_CHECK(SDL_Init(SDL_INIT_EVERYTHING) == 0);
         setup_vmemory();
@@ -930,16 +2042,28 @@ namespace utest{
         // ---- regression tests
 
         utest::t_Virtual_Arena();
+        utest::t_Scratch_Scope();
+        utest::t_Frame_Allocator();
+        utest::t_TLSF_Allocator();
+        utest::t_Block_Pool();
+        utest::t_memtracker();
 
         utest::t_array();
+        utest::t_varray();
+        utest::t_sbarray();
         utest::t_pool();
         utest::t_dhashmap();
         utest::t_dhashmap_randomized();
+        utest::t_hashmap();
+        utest::t_allocator_policy();
+        utest::t_string_id();
 
         utest::t_quat_rot();
         utest::t_defer();
         utest::t_align();
         utest::t_isort();
+        utest::t_introsort();
+        utest::t_radix_sort();
         utest::t_binsearch();
         utest::t_constexpr_sqrt();
         utest::t_Dense_Grid();
@@ -951,14 +2075,24 @@ namespace utest{
 
         utest::t_GJK();
 
+        archecs_unit_test();
+
         // ---- benchmark
 
         //utest::t_detect_vector_capacilities();
         //utest::t_find_noise_magic_normalizer();
         //utest::t_compare_triangulation_2D();
+        //utest::t_compare_sbarray();
+        //utest::t_compare_sort();
+        //utest::t_compare_hash();
+        //utest::t_compare_hashmap();
+        //utest::t_compare_hashmap_search_many();
+        //utest::t_archecs_archetype_lookup();
 
         // ----
 
+        destroy_string_table();
+        destroy_scratch_arena();
         SDL_Quit();
 
     }
@@ -1,21 +1,61 @@
 namespace archecs{
     // --
 
-    s32 add_type(const Manager& manager, const Type_Metadata* type_metadata, Archetype& archetype, u32 type_ID){
-        assert(archetype.ntypes != max_ntypes);
+    Type_Mask type_mask(const u16* type_IDs, u32 ntypes){
+        Type_Mask mask;
+        memset(&mask, 0x00, sizeof(Type_Mask));
+        for(u32 itype = 0u; itype != ntypes; ++itype) type_mask_set(mask, type_IDs[itype]);
+        return mask;
+    }
+
+    void type_mask_set(Type_Mask& mask, u32 type_ID){
+        assert(type_ID < max_types);
+        mask.words[type_ID / 64u] |= (1ull << (type_ID % 64u));
+    }
+
+    void type_mask_unset(Type_Mask& mask, u32 type_ID){
+        assert(type_ID < max_types);
+        mask.words[type_ID / 64u] &= ~(1ull << (type_ID % 64u));
+    }
+
+    bool type_mask_test(const Type_Mask& mask, u32 type_ID){
+        assert(type_ID < max_types);
+        return mask.words[type_ID / 64u] & (1ull << (type_ID % 64u));
+    }
+
+    u32 type_mask_rank(const Type_Mask& mask, u32 type_ID){
+        assert(type_ID < max_types);
+        u32 iword = type_ID / 64u;
+
+        u32 rank = popcount((u64)(mask.words[iword] & ((1ull << (type_ID % 64u)) - 1ull)));
+        for(u32 iprev = 0u; iprev != iword; ++iprev) rank += popcount(mask.words[iprev]);
+
+        return rank;
+    }
+
+    bool type_mask_contains(const Type_Mask& mask, const Type_Mask& subset){
+        u64 missing = 0u;
+        for(u32 iword = 0u; iword != max_types / 64u; ++iword) missing |= subset.words[iword] & ~mask.words[iword];
+        return !missing;
+    }
+
+    DEFINE_EQUALITY_OPERATOR(Type_Mask)
+
+    // --
 
-        // NOTE(hugo): find insertion index
-        u32 index = 0u;
-        while(index != archetype.ntypes && archetype.type_IDs[index] < type_ID) ++index;
+    s32 add_type(const Manager& manager, const Type_Metadata* type_metadata, Archetype& archetype, u32 type_ID){
+        if(type_mask_test(archetype.mask, type_ID)) return -1;
 
-        if(index < archetype.ntypes && archetype.type_IDs[index] == type_ID) return -1;
+        assert(archetype.ntypes != max_ntypes);
 
         // NOTE(hugo): insert type index
+        u32 index = type_mask_rank(archetype.mask, type_ID);
         for(u32 itype = archetype.ntypes; itype != index; --itype){
             archetype.type_IDs[itype] = archetype.type_IDs[itype - 1u];
         }
         archetype.type_IDs[index] = type_ID;
         ++archetype.ntypes;
+        type_mask_set(archetype.mask, type_ID);
 
         update_archetype_metadata(manager, type_metadata, archetype);
 
@@ -23,17 +63,15 @@ namespace archecs{
     }
 
     s32 remove_type(const Manager& manager, const Type_Metadata* type_metadata, Archetype& archetype, u32 type_ID){
-        // NOTE(hugo): find type index
-        u32 index = 0u;
-        while(index != archetype.ntypes && archetype.type_IDs[index] < type_ID) ++index;
-
-        if(index == archetype.ntypes || archetype.type_IDs[index] != type_ID) return -1;
+        if(!type_mask_test(archetype.mask, type_ID)) return -1;
 
         // NOTE(hugo): remove type index
+        u32 index = type_mask_rank(archetype.mask, type_ID);
         for(u32 itype = index; itype != archetype.ntypes - 1u; ++itype){
             archetype.type_IDs[itype] = archetype.type_IDs[itype + 1u];
         }
         --archetype.ntypes;
+        type_mask_unset(archetype.mask, type_ID);
 
         update_archetype_metadata(manager, type_metadata, archetype);
 
@@ -80,42 +118,137 @@ namespace archecs{
     }
 
     s32 search_type(const Archetype& archetype, u32 type_ID){
-        // NOTE(hugo): find type index
-        u32 index = 0u;
-        while(index != archetype.ntypes && archetype.type_IDs[index] < type_ID) ++index;
+        if(!type_mask_test(archetype.mask, type_ID))    return -1;
+        else                                            return (s32)type_mask_rank(archetype.mask, type_ID);
+    }
+
+    Archetype_Signature archetype_signature(const Archetype& archetype){
+        return archetype.mask;
+    }
 
-        if(index == archetype.ntypes || archetype.type_IDs[index] != type_ID)   return -1;
-        else                                                                    return index;
+    u32 hashmap_hash(const Archetype_Signature& signature){
+        return hash_FNV1a_32ptr((u8*)&signature, sizeof(Archetype_Signature));
     }
 
-    u32 allocate_archetype(Manager& manager){
-        if(manager.free_archetype_head){
-            Archetype* free_ptr = manager.free_archetype_head;
-            manager.free_archetype_head = *(Archetype**)free_ptr;
-            return free_ptr - manager.archetypes.data;
+    static inline u64 archetype_edge_key(u32 arch_index, u32 type_ID, bool add){
+        return ((u64)arch_index << 32u) | ((u64)type_ID << 1u) | (u64)add;
+    }
+
+    // NOTE(hugo): /type_indices/ receives the index of each type in the archetype
+    static u32 assess_archetype(const Type_Mask& mask, u32 ntypes, const u16* type_IDs, const Archetype& arch, u16* type_offsets, u16* type_indices){
+        if(!type_mask_contains(arch.mask, mask)) return 0u;
+
+        for(u32 isys = 0u; isys != ntypes; ++isys){
+            u32 iarch = type_mask_rank(arch.mask, type_IDs[isys]);
+            type_offsets[isys] = arch.type_offsets[iarch];
+            type_indices[isys] = iarch;
         }
 
-        u32 index = manager.archetypes.size;
+        return 1u;
+    }
+
+    static void query_add_archetype(Manager& manager, Query* query, u32 arch_index){
+        Query_Match match;
+        match.arch_index = arch_index;
+        if(assess_archetype(query->mask, query->ntypes, query->type_IDs, manager.archetypes[arch_index], match.type_offsets, match.type_indices)){
+            query->matches.push(match);
+        }
+    }
 
-        Archetype archetype;
-        manager.archetypes.push(archetype);
+    u32 allocate_archetype(Manager& manager, const Archetype& arch){
+        u32 index = manager.archetypes.size;
+        manager.archetypes.push(arch);
 
         Archetype_Storage storage;
         storage.nentities = 0u;
         storage.free = 0u;
         storage.chunks.create();
+        storage.versions.create();
         manager.storage.push(storage);
 
+        u32* map_index;
+        bool created = manager.archetype_map.get(archetype_signature(arch), map_index);
+        assert(created);
+        *map_index = index;
+
+        for(auto& query : manager.queries) query_add_archetype(manager, query, index);
+
+        return index;
+    }
+
+    u32 search_archetype(const Manager& manager, const Archetype& arch){
+        u32* index;
+        if(manager.archetype_map.search(archetype_signature(arch), index)) return *index;
+        return UINT32_MAX;
+    }
+
+    u32 get_archetype(Manager& manager, const Archetype& arch){
+        u32 index = search_archetype(manager, arch);
+        if(index == UINT32_MAX) index = allocate_archetype(manager, arch);
         return index;
     }
 
-    void deallocate_archetype(Manager& manager, u32 index){
-        assert(index < manager.archetypes.size);
-        assert(!manager.storage[index].chunks.size && !manager.storage[index].nentities);
+    static u32 get_archetype_edge(Manager& manager, const Type_Metadata* type_metadata, u32 arch_index, u32 type_ID, bool add){
+        assert(arch_index < manager.archetypes.size);
+
+        u32* edge;
+        if(manager.archetype_edges.search(archetype_edge_key(arch_index, type_ID, add), edge)) return *edge;
+
+        Archetype new_arch = manager.archetypes[arch_index];
+        s32 type_index = add ? add_type(manager, type_metadata, new_arch, type_ID)
+                             : remove_type(manager, type_metadata, new_arch, type_ID);
+        if(type_index == -1) return arch_index;
+
+        u32 new_arch_index = get_archetype(manager, new_arch);
+
+        // NOTE(hugo): the reverse edge is known as well
+        manager.archetype_edges.get(archetype_edge_key(arch_index, type_ID, add), edge);
+        *edge = new_arch_index;
+        manager.archetype_edges.get(archetype_edge_key(new_arch_index, type_ID, !add), edge);
+        *edge = arch_index;
+
+        return new_arch_index;
+    }
+
+    u32 get_archetype_with_type(Manager& manager, const Type_Metadata* type_metadata, u32 arch_index, u32 type_ID){
+        return get_archetype_edge(manager, type_metadata, arch_index, type_ID, true);
+    }
+
+    u32 get_archetype_without_type(Manager& manager, const Type_Metadata* type_metadata, u32 arch_index, u32 type_ID){
+        return get_archetype_edge(manager, type_metadata, arch_index, type_ID, false);
+    }
+
+    static Chunk* acquire_chunk(Manager& man){
+        Chunk* new_chunk;
+        if(man.free_chunk_head){
+            new_chunk = man.free_chunk_head;
+            man.free_chunk_head = *(Chunk**)man.free_chunk_head;
+            --man.nfree_chunks;
+
+        }else{
+            new_chunk = man.chunk_pool.allocate<Chunk>();
+            assert(new_chunk);
+        }
+        return new_chunk;
+    }
+
+    // NOTE(hugo): structural changes are tagged with the version of the next system execution
+    static inline u32 structural_version(const Manager& man){
+        return man.version + 1u;
+    }
+
+    static void push_chunk(Manager& man, const Archetype& arch, Archetype_Storage& storage){
+        storage.chunks.push(acquire_chunk(man));
+
+        u32 version = structural_version(man);
+        for(u32 itype = 0u; itype != arch.ntypes; ++itype) storage.versions.push(version);
+    }
+
+    static void mark_chunk_changed(const Manager& man, const Archetype& arch, Archetype_Storage& storage, u32 chunk_index){
+        u32* chunk_versions = storage.versions.data + chunk_index * arch.ntypes;
 
-        Archetype* free_ptr = &manager.archetypes[index];
-        *(Archetype**)free_ptr = manager.free_archetype_head;
-        manager.free_archetype_head = free_ptr;
+        u32 version = structural_version(man);
+        for(u32 itype = 0u; itype != arch.ntypes; ++itype) chunk_versions[itype] = version;
     }
 
     u32 allocate_entity_storage(Manager& man, const Archetype& arch, Archetype_Storage& storage){
@@ -128,23 +261,38 @@ namespace archecs{
         // NOTE(hugo): chunk space available
         if(storage.free){
             --storage.free;
+            mark_chunk_changed(man, arch, storage, storage.chunks.size - 1u);
             return storage.nentities++;
         }
 
         // NOTE(hugo): no chunk space ; retrieve / allocate a chunk
-        Chunk* new_chunk;
-        if(man.free_chunk_head){
-            new_chunk = man.free_chunk_head;
-            man.free_chunk_head = *(Chunk**)man.free_chunk_head;
+        push_chunk(man, arch, storage);
+        storage.free = arch.entities_per_chunk - 1u;
 
-        }else{
-            new_chunk = (Chunk*)bw_malloc(sizeof(Chunk));
+        return storage.nentities++;
+    }
+
+    u32 allocate_entities_storage(Manager& man, const Archetype& arch, Archetype_Storage& storage, u32 count){
+        // NOTE(hugo): nothing to allocate
+        if(arch.entities_per_chunk == infinite_entities_per_chunk){
+            storage.nentities += count;
+            return UINT32_MAX;
         }
 
-        storage.chunks.push(new_chunk);
-        storage.free = arch.entities_per_chunk - 1u;
+        u32 first = storage.nentities;
 
-        return storage.nentities++;
+        if(storage.free && count) mark_chunk_changed(man, arch, storage, storage.chunks.size - 1u);
+
+        u32 remaining = count;
+        while(remaining > storage.free){
+            remaining -= storage.free;
+            push_chunk(man, arch, storage);
+            storage.free = arch.entities_per_chunk;
+        }
+        storage.free -= remaining;
+        storage.nentities += count;
+
+        return first;
     }
 
     u32 deallocate_entity_storage(Manager& man, const Type_Metadata* type_metadata, const Archetype& arch, Archetype_Storage& storage, u32 index){
@@ -172,6 +320,8 @@ namespace archecs{
                 void* dst_ptr = remove_chunk->data + type_offset + remove_sub_index * type_bytesize;
                 memcpy(dst_ptr, src_ptr, type_bytesize);
             }
+
+            mark_chunk_changed(man, arch, storage, remove_chunk_index);
         }
 
         ++storage.free;
@@ -180,7 +330,9 @@ namespace archecs{
         if(storage.free == arch.entities_per_chunk){
             *(Chunk**)move_chunk = man.free_chunk_head;
             man.free_chunk_head = move_chunk;
+            ++man.nfree_chunks;
             storage.chunks.pop();
+            storage.versions.resize(storage.versions.size - arch.ntypes);
             storage.free = 0u;
         }
 
@@ -189,25 +341,15 @@ namespace archecs{
     }
 
     Entity allocate_entity(Manager& manager, const Archetype& arch){
-        Entity entity;
-
-        for(u32 iarch = 0u; iarch != manager.archetypes.size; ++iarch){
-            Archetype& other_arch = manager.archetypes[iarch];
-
-            if(other_arch.entities_per_chunk == arch.entities_per_chunk
-            && other_arch.ntypes == arch.ntypes
-            && memcmp(other_arch.type_IDs, arch.type_IDs, arch.ntypes * sizeof(u32)) == 0u){
-                entity.archetype_index = iarch;
-                entity.index = allocate_entity_storage(manager, arch, manager.storage[iarch]);
-
-                return entity;
-            }
-        }
+        return allocate_entity(manager, get_archetype(manager, arch));
+    }
 
-        entity.archetype_index = allocate_archetype(manager);
-        manager.archetypes[entity.archetype_index] = arch;
+    Entity allocate_entity(Manager& manager, u32 arch_index){
+        assert(arch_index < manager.archetypes.size);
 
-        entity.index = allocate_entity_storage(manager, arch, manager.storage[entity.archetype_index]);
+        Entity entity;
+        entity.archetype_index = arch_index;
+        entity.index = allocate_entity_storage(manager, manager.archetypes[arch_index], manager.storage[arch_index]);
 
         return entity;
     }
@@ -217,125 +359,140 @@ namespace archecs{
 
         Archetype& arch = manager.archetypes[entity.archetype_index];
         Archetype_Storage& storage = manager.storage[entity.archetype_index];
-        u32 moved_entity = deallocate_entity_storage(manager, type_metadata, arch, storage, entity.index);
-
-        if(!storage.nentities) deallocate_archetype(manager, entity.archetype_index);
+        return deallocate_entity_storage(manager, type_metadata, arch, storage, entity.index);
+    }
 
-        return moved_entity;
+    void get_entity_ranges(const Manager& manager, u32 arch_index, u32 first, u32 count, array<Entity_Range>& ranges){
+        const Archetype& arch = manager.archetypes[arch_index];
+        const Archetype_Storage& storage = manager.storage[arch_index];
+        assert(arch.entities_per_chunk != infinite_entities_per_chunk);
+
+        u32 index = first;
+        u32 end = first + count;
+        while(index != end){
+            u32 chunk_index = index / arch.entities_per_chunk;
+            u32 chunk_sub_index = index - chunk_index * arch.entities_per_chunk;
+
+            Entity_Range range;
+            range.arch_index = arch_index;
+            range.chunk = storage.chunks[chunk_index];
+            range.first = chunk_sub_index;
+            range.nentities = min(arch.entities_per_chunk - chunk_sub_index, end - index);
+            ranges.push(range);
+
+            index += range.nentities;
+        }
     }
 
-    Entity attach_type(Manager& manager, const Type_Metadata* type_metadata, Entity entity, u32 type_ID){
-        assert(entity.archetype_index < manager.archetypes.size);
+    void* range_memory(const Manager& manager, const Type_Metadata* type_metadata, const Entity_Range& range, u32 type_ID){
+        const Archetype& arch = manager.archetypes[range.arch_index];
 
-        Archetype& arch = manager.archetypes[entity.archetype_index];
+        s32 type_index = search_type(arch, type_ID);
+        if(type_index == -1) return nullptr;
 
-        Archetype new_arch = arch;
-        s32 type_insert = add_type(manager, type_metadata, new_arch, type_ID);
+        return range.chunk->data + arch.type_offsets[type_index] + range.first * type_metadata[type_ID].bytesize;
+    }
 
-        if(type_insert != -1){
-            Entity new_entity = allocate_entity(manager, new_arch);
+    void copy_entities(Manager& manager, const Type_Metadata* type_metadata, u32 src_arch_index, const u32* src_indices, u32 count, u32 dst_arch_index, u32 dst_first){
+        const Archetype& src_arch = manager.archetypes[src_arch_index];
+        const Archetype& dst_arch = manager.archetypes[dst_arch_index];
 
-            if(arch.entities_per_chunk != infinite_entities_per_chunk
-            && new_arch.entities_per_chunk != infinite_entities_per_chunk){
+        if(src_arch.entities_per_chunk == infinite_entities_per_chunk
+        || dst_arch.entities_per_chunk == infinite_entities_per_chunk){
+            return;
+        }
 
-                Archetype_Storage& storage = manager.storage[entity.archetype_index];
-                u32 chunk_index = entity.index / arch.entities_per_chunk;
-                u32 chunk_sub_index = entity.index - chunk_index * arch.entities_per_chunk;
-                Chunk* chunk = storage.chunks[chunk_index];
+        struct{
+            u16 src_offset;
+            u16 dst_offset;
+            u16 bytesize;
+        } shared_types[max_ntypes];
+        u32 nshared_types = 0u;
+
+        for(u32 isrc_type = 0u; isrc_type != src_arch.ntypes; ++isrc_type){
+            u32 type_ID = src_arch.type_IDs[isrc_type];
+            if(!type_mask_test(dst_arch.mask, type_ID)) continue;
+
+            shared_types[nshared_types].src_offset = src_arch.type_offsets[isrc_type];
+            shared_types[nshared_types].dst_offset = dst_arch.type_offsets[type_mask_rank(dst_arch.mask, type_ID)];
+            shared_types[nshared_types].bytesize = type_metadata[type_ID].bytesize;
+            ++nshared_types;
+        }
 
-                Archetype_Storage& new_storage = manager.storage[new_entity.archetype_index];
-                u32 new_chunk_index = new_entity.index / new_arch.entities_per_chunk;
-                u32 new_chunk_sub_index = new_entity.index - new_chunk_index * new_arch.entities_per_chunk;
-                Chunk* new_chunk = new_storage.chunks[new_chunk_index];
+        const Archetype_Storage& src_storage = manager.storage[src_arch_index];
+        const Archetype_Storage& dst_storage = manager.storage[dst_arch_index];
 
-                u32 type_index = (u32)type_insert;
+        u32 ientity = 0u;
+        while(ientity != count){
+            u32 src_index = src_indices[ientity];
+            u32 src_chunk_index = src_index / src_arch.entities_per_chunk;
+            u32 src_sub_index = src_index - src_chunk_index * src_arch.entities_per_chunk;
+            Chunk* src_chunk = src_storage.chunks[src_chunk_index];
 
-                for(u32 itype = 0u; itype != type_index; ++itype){
-                    size_t type_bytesize = type_metadata[arch.type_IDs[itype]].bytesize;
+            u32 dst_index = dst_first + ientity;
+            u32 dst_chunk_index = dst_index / dst_arch.entities_per_chunk;
+            u32 dst_sub_index = dst_index - dst_chunk_index * dst_arch.entities_per_chunk;
+            Chunk* dst_chunk = dst_storage.chunks[dst_chunk_index];
 
-                    void* src_ptr = chunk->data     + arch.type_offsets[itype]      + chunk_sub_index     * type_bytesize;
-                    void* dst_ptr = new_chunk->data + new_arch.type_offsets[itype]  + new_chunk_sub_index * type_bytesize;
-                    memcpy(dst_ptr, src_ptr, type_bytesize);
-                }
-                for(u32 itype = type_index; itype != arch.ntypes; ++itype){
-                    size_t type_bytesize = type_metadata[arch.type_IDs[itype]].bytesize;
+            // NOTE(hugo): extend the run while the entities are contiguous in both chunks
+            u32 max_run = min(src_arch.entities_per_chunk - src_sub_index, dst_arch.entities_per_chunk - dst_sub_index);
+            u32 run = 1u;
+            while(run != max_run && ientity + run != count && src_indices[ientity + run] == src_index + run) ++run;
 
-                    void* src_ptr = chunk->data     + arch.type_offsets[itype]          + chunk_sub_index     * type_bytesize;
-                    void* dst_ptr = new_chunk->data + new_arch.type_offsets[itype + 1u] + new_chunk_sub_index * type_bytesize;
-                    memcpy(dst_ptr, src_ptr, type_bytesize);
-                }
-            }
+            for(u32 itype = 0u; itype != nshared_types; ++itype){
+                size_t type_bytesize = shared_types[itype].bytesize;
 
-            deallocate_entity(manager, type_metadata, entity);
+                void* src_ptr = src_chunk->data + shared_types[itype].src_offset + src_sub_index * type_bytesize;
+                void* dst_ptr = dst_chunk->data + shared_types[itype].dst_offset + dst_sub_index * type_bytesize;
+                memcpy(dst_ptr, src_ptr, run * type_bytesize);
+            }
 
-            return new_entity;
+            ientity += run;
         }
-
-        return entity;
     }
 
-    Entity detach_type(Manager& manager, const Type_Metadata* type_metadata, Entity entity, u32 type_ID){
-        assert(entity.archetype_index < manager.archetypes.size);
-
-        Archetype& arch = manager.archetypes[entity.archetype_index];
-
-        Archetype new_arch = arch;
-        s32 type_insert = remove_type(manager, type_metadata, new_arch, type_ID);
+    // NOTE(hugo): copies the types shared by both archetypes and deallocates the source entity
+    static Entity move_entity(Manager& manager, const Type_Metadata* type_metadata, Entity entity, u32 new_arch_index, u32& moved_index){
+        Entity new_entity = allocate_entity(manager, new_arch_index);
+        copy_entities(manager, type_metadata, entity.archetype_index, &entity.index, 1u, new_entity.archetype_index, new_entity.index);
 
-        if(type_insert != -1){
-            Entity new_entity = allocate_entity(manager, new_arch);
+        moved_index = deallocate_entity(manager, type_metadata, entity);
 
-            if(arch.entities_per_chunk != infinite_entities_per_chunk
-            && new_arch.entities_per_chunk != infinite_entities_per_chunk){
+        return new_entity;
+    }
 
-                Archetype_Storage& storage = manager.storage[entity.archetype_index];
-                u32 chunk_index = entity.index / arch.entities_per_chunk;
-                u32 chunk_sub_index = entity.index - chunk_index * arch.entities_per_chunk;
-                Chunk* chunk = storage.chunks[chunk_index];
+    Entity attach_type(Manager& manager, const Type_Metadata* type_metadata, Entity entity, u32 type_ID, u32& moved_index){
+        assert(entity.archetype_index < manager.archetypes.size);
 
-                Archetype_Storage& new_storage = manager.storage[new_entity.archetype_index];
-                u32 new_chunk_index = new_entity.index / new_arch.entities_per_chunk;
-                u32 new_chunk_sub_index = new_entity.index - new_chunk_index * new_arch.entities_per_chunk;
-                Chunk* new_chunk = new_storage.chunks[new_chunk_index];
+        moved_index = entity.index;
 
-                u32 type_index = (u32)type_insert;
-                for(u32 itype = 0u; itype != type_index; ++itype){
-                    size_t type_bytesize = type_metadata[arch.type_IDs[itype]].bytesize;
+        u32 new_arch_index = get_archetype_with_type(manager, type_metadata, entity.archetype_index, type_ID);
+        if(new_arch_index == entity.archetype_index) return entity;
 
-                    void* src_ptr = chunk->data     + arch.type_offsets[itype]      + chunk_sub_index     * type_bytesize;
-                    void* dst_ptr = new_chunk->data + new_arch.type_offsets[itype]  + new_chunk_sub_index * type_bytesize;
-                    memcpy(dst_ptr, src_ptr, type_bytesize);
-                }
-                for(u32 itype = type_index + 1u; itype != arch.ntypes; ++itype){
-                    size_t type_bytesize = type_metadata[arch.type_IDs[itype]].bytesize;
+        return move_entity(manager, type_metadata, entity, new_arch_index, moved_index);
+    }
 
-                    void* src_ptr = chunk->data     + arch.type_offsets[itype]  + chunk_sub_index     * type_bytesize;
-                    void* dst_ptr = new_chunk->data + new_arch.type_offsets[itype - 1u]   + new_chunk_sub_index * type_bytesize;
-                    memcpy(dst_ptr, src_ptr, type_bytesize);
-                }
-            }
+    Entity detach_type(Manager& manager, const Type_Metadata* type_metadata, Entity entity, u32 type_ID, u32& moved_index){
+        assert(entity.archetype_index < manager.archetypes.size);
 
-            deallocate_entity(manager, type_metadata, entity);
+        moved_index = entity.index;
 
-            return new_entity;
-        }
+        u32 new_arch_index = get_archetype_without_type(manager, type_metadata, entity.archetype_index, type_ID);
+        if(new_arch_index == entity.archetype_index) return entity;
 
-        return entity;
+        return move_entity(manager, type_metadata, entity, new_arch_index, moved_index);
     }
 
     void* type_memory(Manager& manager, const Type_Metadata* type_metadata, Entity entity, u32 type_ID){
         Archetype& arch = manager.archetypes[entity.archetype_index];
 
-        // NOTE(hugo): find index in arch
-        u32 type_index = 0u;
-        while(type_index != arch.ntypes && arch.type_IDs[type_index] < type_ID) ++type_index;
-
-        if(type_index == arch.ntypes
-        || arch.type_IDs[type_index] != type_ID
+        if(!type_mask_test(arch.mask, type_ID)
         || arch.entities_per_chunk == infinite_entities_per_chunk){
             return nullptr;
         }
 
+        u32 type_index = type_mask_rank(arch.mask, type_ID);
+
         u32 chunk_index = entity.index / arch.entities_per_chunk;
         u32 chunk_sub_index = entity.index - chunk_index * arch.entities_per_chunk;
         Chunk* chunk = manager.storage[entity.archetype_index].chunks[chunk_index];
@@ -346,70 +503,717 @@ namespace archecs{
     void create_manager(Manager& manager){
         manager.archetypes.create();
         manager.storage.create();
-        manager.free_archetype_head = nullptr;
         manager.free_chunk_head = nullptr;
+        manager.nfree_chunks = 0u;
+        manager.chunk_pool.create(sizeof(Chunk), chunks_per_slab);
+        manager.version = 0u;
+        manager.snapshot = {nullptr, 0u};
+        manager.snapshot_path = "";
+        manager.archetype_map.create();
+        manager.archetype_edges.create();
+        manager.parallel_params.create();
+        manager.queries.create();
+    }
+
+    // NOTE(hugo): destroys the storage of every archetype, releases the chunk pool in bulk then unmaps the snapshot
+    // the chunk pool must be created again before allocating chunks
+    static void release_storage(Manager& manager){
+        for(auto& storage : manager.storage){
+            storage.chunks.destroy();
+            storage.versions.destroy();
+        }
+
+        manager.free_chunk_head = nullptr;
+        manager.nfree_chunks = 0u;
+        manager.chunk_pool.destroy();
+
+        unmap_file(manager.snapshot);
     }
 
     void destroy_manager(Manager& manager){
         manager.archetypes.destroy();
+        manager.archetype_map.destroy();
+        manager.archetype_edges.destroy();
+        manager.parallel_params.destroy();
+
+        for(auto& query : manager.queries){
+            query->matches.destroy();
+            bw_free(query);
+        }
+        manager.queries.destroy();
+
+        release_storage(manager);
+        manager.storage.destroy();
+    }
+
+    size_t compact_manager(Manager& manager, u32 nkeep_free_chunks, size_t max_bytesize, u64 max_ticks){
+        u64 start_ticks = timer_ticks();
+        size_t released_bytesize = 0u;
+
+        auto budget_available = [&](){
+            return released_bytesize < max_bytesize && timer_ticks() - start_ticks < max_ticks;
+        };
+
+        // NOTE(hugo): chunks of the snapshot are dropped from the free list and released with the mapping
+        u8* snapshot_begin = (u8*)manager.snapshot.data;
+        while(manager.nfree_chunks > nkeep_free_chunks && budget_available()){
+            Chunk* chunk = manager.free_chunk_head;
+            manager.free_chunk_head = *(Chunk**)chunk;
+            --manager.nfree_chunks;
+
+            if((u8*)chunk < snapshot_begin || (u8*)chunk >= snapshot_begin + manager.snapshot.bytesize){
+                manager.chunk_pool.free(chunk);
+            }
+        }
+
+        // NOTE(hugo): memory is only released by whole slabs ie a slab with a chunk in use or in the free list is kept
+        if(budget_available()){
+            u64 deadline_ticks = max_ticks < UINT64_MAX - start_ticks ? start_ticks + max_ticks : UINT64_MAX;
+            released_bytesize += manager.chunk_pool.release_empty_slabs(max_bytesize - released_bytesize, deadline_ticks);
+        }
 
+        // NOTE(hugo): chunk arrays keep their capacity after the archetype got empty
+        for(auto& storage : manager.storage){
+            if(!budget_available()) break;
+
+            if(!storage.chunks.size && storage.chunks.capacity){
+                released_bytesize += storage.chunks.capacity * sizeof(Chunk*) + storage.versions.capacity * sizeof(u32);
+
+                storage.chunks.destroy();
+                storage.chunks.create();
+                storage.versions.destroy();
+                storage.versions.create();
+            }
+        }
+
+        return released_bytesize;
+    }
+
+    // ---- snapshot
+    // NOTE(hugo): layout
+    // Snapshot_Header
+    // Snapshot_Type[ntypes]
+    // Archetype[narchetypes]
+    // Snapshot_Storage[narchetypes]
+    // u32[nversions] ie versions of every storage one after the other
+    // indexmap<Entity>::mapping[entity_map_size]
+    // padding up to chunks_offset ie a multiple of chunk_bytesize
+    // Chunk[nchunks] ie chunks of every storage one after the other
+    // every section is padded to snapshot_section_alignment ie the mapping is read in place
+
+    constexpr u32 snapshot_magic = 0x53434541u; // NOTE(hugo): "AECS"
+    constexpr u32 snapshot_format_version = 4u;
+
+    struct Snapshot_Header{
+        u32 magic;
+        u32 format_version;
+        u32 chunk_bytesize;
+        u32 max_types;
+        u32 max_ntypes;
+        u32 ntypes;
+        u32 narchetypes;
+        u32 nchunks;
+        u32 nversions;
+        u32 entity_map_size;
+        u32 entity_map_inactive_head;
+        u32 version;
+        u64 chunks_offset;
+    };
+
+    struct Snapshot_Type{
+        u16 bytesize;
+        u16 alignment;
+    };
+
+    struct Snapshot_Storage{
+        u32 nentities;
+        u32 free;
+        u32 nchunks;
+    };
+
+    constexpr size_t snapshot_section_alignment = 8u;
+    static_assert(alignof(Archetype) <= snapshot_section_alignment && alignof(indexmap<Entity>::mapping) <= snapshot_section_alignment);
+
+    struct Snapshot_Layout{
+        size_t types_offset;
+        size_t archetypes_offset;
+        size_t storage_offset;
+        size_t versions_offset;
+        size_t entity_map_offset;
+        size_t metadata_bytesize;
+    };
+
+    static Snapshot_Layout snapshot_layout(const Snapshot_Header& header){
+        Snapshot_Layout layout;
+        layout.types_offset         = round_up_multiple(sizeof(Snapshot_Header), snapshot_section_alignment);
+        layout.archetypes_offset    = round_up_multiple(layout.types_offset + header.ntypes * sizeof(Snapshot_Type), snapshot_section_alignment);
+        layout.storage_offset       = round_up_multiple(layout.archetypes_offset + header.narchetypes * sizeof(Archetype), snapshot_section_alignment);
+        layout.versions_offset      = round_up_multiple(layout.storage_offset + header.narchetypes * sizeof(Snapshot_Storage), snapshot_section_alignment);
+        layout.entity_map_offset    = round_up_multiple(layout.versions_offset + header.nversions * sizeof(u32), snapshot_section_alignment);
+        layout.metadata_bytesize    = layout.entity_map_offset + header.entity_map_size * sizeof(indexmap<Entity>::mapping);
+        return layout;
+    }
+
+    bool save_snapshot(const Manager& manager, const Type_Metadata* type_metadata, u32 ntypes, const indexmap<Entity>& entity_map, const File_Path& path){
+#if defined(PLATFORM_WINDOWS)
+        // NOTE(hugo): a mapped file can not be replaced
+        if(manager.snapshot.data && path == manager.snapshot_path){
+            LOG_ERROR("save_snapshot(%s) FAILED - the file is mapped by the manager", path.data);
+            return false;
+        }
+#endif
+
+        Snapshot_Header header;
+        header.magic = snapshot_magic;
+        header.format_version = snapshot_format_version;
+        header.chunk_bytesize = chunk_bytesize;
+        header.max_types = max_types;
+        header.max_ntypes = max_ntypes;
+        header.ntypes = ntypes;
+        header.narchetypes = manager.archetypes.size;
+        header.nchunks = 0u;
+        header.nversions = 0u;
+        for(auto& storage : manager.storage){
+            header.nchunks += storage.chunks.size;
+            header.nversions += storage.versions.size;
+        }
+        header.entity_map_size = entity_map.map.size;
+        header.entity_map_inactive_head = entity_map.inactive_head;
+        header.version = manager.version;
+
+        Snapshot_Layout layout = snapshot_layout(header);
+        header.chunks_offset = round_up_multiple(layout.metadata_bytesize, chunk_bytesize);
+
+        // NOTE(hugo): the chunks may live in a mapping of /path/ after load_snapshot ie the file is written aside and renamed over /path/
+        if(path.size() + 4u >= File_Path::bytesize){
+            LOG_ERROR("save_snapshot(%s) FAILED - path too long", path.data);
+            return false;
+        }
+        char tmp_str[File_Path::bytesize];
+        memcpy(tmp_str, path.data, path.size());
+        memcpy(tmp_str + path.size(), ".tmp", sizeof(".tmp"));
+        File_Path tmp_path;
+        tmp_path = tmp_str;
+
+        FILE* f = fopen(tmp_path.data, "wb");
+        if(f == NULL){
+            LOG_ERROR("save_snapshot(%s) FAILED - fopen", tmp_path.data);
+            return false;
+        }
+
+        size_t file_cursor = 0u;
+        auto write_padding = [&](size_t offset){
+            for(; file_cursor != offset; ++file_cursor) fputc(0, f);
+        };
+        auto write_bytes = [&](const void* data, size_t bytesize){
+            if(bytesize) fwrite(data, 1u, bytesize, f);
+            file_cursor += bytesize;
+        };
+
+        write_bytes(&header, sizeof(Snapshot_Header));
+
+        write_padding(layout.types_offset);
+        for(u32 itype = 0u; itype != ntypes; ++itype){
+            Snapshot_Type type = {type_metadata[itype].bytesize, type_metadata[itype].alignment};
+            write_bytes(&type, sizeof(Snapshot_Type));
+        }
+
+        write_padding(layout.archetypes_offset);
+        write_bytes(manager.archetypes.data, manager.archetypes.size * sizeof(Archetype));
+
+        write_padding(layout.storage_offset);
+        for(auto& storage : manager.storage){
+            Snapshot_Storage snapshot_storage = {storage.nentities, storage.free, (u32)storage.chunks.size};
+            write_bytes(&snapshot_storage, sizeof(Snapshot_Storage));
+        }
+
+        write_padding(layout.versions_offset);
+        for(auto& storage : manager.storage){
+            write_bytes(storage.versions.data, storage.versions.size * sizeof(u32));
+        }
+
+        write_padding(layout.entity_map_offset);
+        write_bytes(entity_map.map.data, entity_map.map.size * sizeof(indexmap<Entity>::mapping));
+
+        write_padding(header.chunks_offset);
         for(auto& storage : manager.storage){
             for(auto& chunk : storage.chunks){
-                bw_free(chunk);
+                write_bytes(chunk, sizeof(Chunk));
             }
-            storage.chunks.destroy();
         }
-        manager.storage.destroy();
 
-        Chunk* ptr = manager.free_chunk_head;
-        while(ptr){
-            Chunk* to_free = ptr;
-            ptr = *(Chunk**)ptr;
-            bw_free(to_free);
+        bool success = !ferror(f);
+        success &= fclose(f) == 0;
+
+        if(!success){
+            LOG_ERROR("save_snapshot(%s) FAILED - fwrite", tmp_path.data);
+            remove(tmp_path.data);
+            return false;
+        }
+
+        if(!replace_file(tmp_path, path)){
+            remove(tmp_path.data);
+            return false;
+        }
+
+        return true;
+    }
+
+    // NOTE(hugo): everything load_snapshot indexes with is checked ie the types, the archetypes, the storage counts and the entity_map
+    // the content of the chunks and the versions is not
+    static bool snapshot_valid(const Manager& manager, const File_Mapping& mapping, const Type_Metadata* type_metadata, u32 ntypes){
+        if(mapping.bytesize < sizeof(Snapshot_Header)) return false;
+
+        const Snapshot_Header& header = *(const Snapshot_Header*)mapping.data;
+        Snapshot_Layout layout = snapshot_layout(header);
+        if(header.magic != snapshot_magic
+        || header.format_version != snapshot_format_version
+        || header.chunk_bytesize != chunk_bytesize
+        || header.max_types != max_types
+        || header.max_ntypes != max_ntypes
+        || header.ntypes != ntypes
+        || header.chunks_offset < layout.metadata_bytesize
+        || header.chunks_offset % chunk_bytesize
+        || header.chunks_offset > mapping.bytesize
+        || (mapping.bytesize - header.chunks_offset) / sizeof(Chunk) < header.nchunks
+        || header.entity_map_inactive_head > header.entity_map_size)
+            return false;
+
+        const u8* data = (const u8*)mapping.data;
+
+        const Snapshot_Type* types = (const Snapshot_Type*)(data + layout.types_offset);
+        for(u32 itype = 0u; itype != ntypes; ++itype){
+            if(types[itype].bytesize != type_metadata[itype].bytesize
+            || types[itype].alignment != type_metadata[itype].alignment)
+                return false;
+        }
+
+        // NOTE(hugo): the type_IDs are sorted and match the mask ; the offsets and the capacity are computed again
+        const Archetype* archetypes = (const Archetype*)(data + layout.archetypes_offset);
+        for(u32 iarch = 0u; iarch != header.narchetypes; ++iarch){
+            const Archetype& arch = archetypes[iarch];
+            if(arch.ntypes > max_ntypes) return false;
+
+            for(u32 itype = 0u; itype != arch.ntypes; ++itype){
+                if(arch.type_IDs[itype] >= ntypes
+                || (itype && arch.type_IDs[itype] <= arch.type_IDs[itype - 1u]))
+                    return false;
+            }
+            if(arch.mask != type_mask(arch.type_IDs, arch.ntypes)) return false;
+
+            Archetype expected = arch;
+            update_archetype_metadata(manager, type_metadata, expected);
+            if(expected.entities_per_chunk != arch.entities_per_chunk
+            || memcmp(expected.type_offsets, arch.type_offsets, arch.ntypes * sizeof(u16)))
+                return false;
+        }
+
+        // NOTE(hugo): the storage is dense ie only the last chunk is partially filled
+        const Snapshot_Storage* snapshot_storage = (const Snapshot_Storage*)(data + layout.storage_offset);
+        u64 nchunks = 0u;
+        u64 nversions = 0u;
+        for(u32 iarch = 0u; iarch != header.narchetypes; ++iarch){
+            const Snapshot_Storage& storage = snapshot_storage[iarch];
+            u32 entities_per_chunk = archetypes[iarch].entities_per_chunk;
+
+            if(entities_per_chunk == infinite_entities_per_chunk || entities_per_chunk == 0u){
+                if(storage.nchunks || storage.free) return false;
+                if(entities_per_chunk == 0u && storage.nentities) return false;
+
+            }else{
+                u64 capacity = (u64)storage.nchunks * entities_per_chunk;
+                if(storage.nentities > capacity
+                || storage.free != capacity - storage.nentities
+                || storage.free >= entities_per_chunk)
+                    return false;
+            }
+
+            nchunks += storage.nchunks;
+            nversions += (u64)storage.nchunks * archetypes[iarch].ntypes;
+        }
+        if(nchunks != header.nchunks || nversions != header.nversions) return false;
+
+        // NOTE(hugo): the inactive handles are linked from the inactive head ; the other handles must point to an entity
+        typedef indexmap<Entity>::mapping Entity_Mapping;
+        const Entity_Mapping* entity_mappings = (const Entity_Mapping*)(data + layout.entity_map_offset);
+
+        array<bool> inactive;
+        inactive.create();
+        inactive.resize(header.entity_map_size);
+        if(header.entity_map_size) memset(inactive.data, 0, header.entity_map_size * sizeof(bool));
+
+        bool valid = true;
+        for(u32 virtual_index = header.entity_map_inactive_head; virtual_index && valid; ){
+            u32 index = virtual_index - 1u;
+            valid = index < header.entity_map_size && !inactive[index];
+            if(valid){
+                inactive[index] = true;
+                virtual_index = entity_mappings[index].inactive.next;
+            }
+        }
+
+        for(u32 index = 0u; index != header.entity_map_size && valid; ++index){
+            if(inactive[index]) continue;
+
+            const Entity& entity = entity_mappings[index].active.type;
+            valid = entity.archetype_index < header.narchetypes
+                && entity.index < snapshot_storage[entity.archetype_index].nentities;
+        }
+
+        inactive.destroy();
+
+        return valid;
+    }
+
+    bool load_snapshot(Manager& manager, const Type_Metadata* type_metadata, u32 ntypes, indexmap<Entity>& entity_map, const File_Path& path){
+        File_Mapping mapping = map_file(path);
+        if(!mapping.data) return false;
+
+        if(!snapshot_valid(manager, mapping, type_metadata, ntypes)){
+            LOG_ERROR("load_snapshot(%s) FAILED - not a valid snapshot of these types", path.data);
+            unmap_file(mapping);
+            return false;
+        }
+
+        // NOTE(hugo): the queries are referenced by the systems and survive the reload
+        release_storage(manager);
+        manager.chunk_pool.create(sizeof(Chunk), chunks_per_slab);
+        manager.storage.clear();
+        manager.archetype_map.clear();
+        manager.archetype_edges.clear();
+        for(auto& query : manager.queries) query->matches.clear();
+
+        const u8* data = (const u8*)mapping.data;
+        const Snapshot_Header& header = *(const Snapshot_Header*)data;
+        Snapshot_Layout layout = snapshot_layout(header);
+
+        manager.archetypes.resize(header.narchetypes);
+        if(header.narchetypes) memcpy(manager.archetypes.data, data + layout.archetypes_offset, header.narchetypes * sizeof(Archetype));
+
+        const Snapshot_Storage* snapshot_storage = (const Snapshot_Storage*)(data + layout.storage_offset);
+        const u32* versions = (const u32*)(data + layout.versions_offset);
+        Chunk* chunks = (Chunk*)((u8*)mapping.data + header.chunks_offset);
+
+        manager.storage.resize(header.narchetypes);
+        for(u32 iarch = 0u; iarch != header.narchetypes; ++iarch){
+            Archetype_Storage& storage = manager.storage[iarch];
+            storage.nentities = snapshot_storage[iarch].nentities;
+            storage.free = snapshot_storage[iarch].free;
+
+            storage.chunks.create();
+            storage.chunks.resize(snapshot_storage[iarch].nchunks);
+            for(u32 ichunk = 0u; ichunk != storage.chunks.size; ++ichunk){
+                storage.chunks[ichunk] = chunks++;
+            }
+
+            storage.versions.create();
+            u32 nversions = storage.chunks.size * manager.archetypes[iarch].ntypes;
+            if(nversions){
+                storage.versions.resize(nversions);
+                memcpy(storage.versions.data, versions, nversions * sizeof(u32));
+                versions += nversions;
+            }
+
+            u32* map_index;
+            manager.archetype_map.get(archetype_signature(manager.archetypes[iarch]), map_index);
+            *map_index = iarch;
+
+            for(auto& query : manager.queries) query_add_archetype(manager, query, iarch);
         }
+
+        entity_map.map.resize(header.entity_map_size);
+        if(header.entity_map_size) memcpy(entity_map.map.data, data + layout.entity_map_offset, header.entity_map_size * sizeof(indexmap<Entity>::mapping));
+        entity_map.inactive_head = header.entity_map_inactive_head;
+
+        manager.version = header.version;
+        manager.snapshot = mapping;
+        manager.snapshot_path = path;
+
+        return true;
     }
 
     u32 system_assess_archetype(const System& sys, const Archetype& arch, System_Param& param){
-        if(arch.ntypes < sys.ntypes) return 0u;
+        u16 type_indices[max_ntypes];
+        return assess_archetype(sys.mask, sys.ntypes, sys.type_IDs, arch, param.type_offsets, type_indices);
+    }
+
+    Query* create_query(Manager& manager, const System& system){
+        Query* query = (Query*)bw_malloc(sizeof(Query));
+        query->mask = system.mask;
+        query->ntypes = system.ntypes;
+        memcpy(query->type_IDs, system.type_IDs, sizeof(system.type_IDs));
+        query->matches.create();
+
+        // NOTE(hugo): every archetype is registered in the archetype_map
+        for(auto& iter : manager.archetype_map){
+            query_add_archetype(manager, query, iter.value());
+        }
+
+        manager.queries.push(query);
 
-        u32 iarch = 0u;
-        u32 isys = 0u;
+        return query;
+    }
 
-        while(iarch != arch.ntypes){
-            if(sys.type_IDs[isys] == arch.type_IDs[iarch]){
-                param.type_offsets[isys] = arch.type_offsets[iarch];
-                ++isys;
-                if(isys == sys.ntypes) return 1u;
+    void destroy_query(Manager& manager, Query* query){
+        for(u32 iquery = 0u; iquery != manager.queries.size; ++iquery){
+            if(manager.queries[iquery] == query){
+                manager.queries.remove_swap(iquery);
+                break;
             }
-            ++iarch;
         }
 
-        return 0u;
+        query->matches.destroy();
+        bw_free(query);
+    }
+
+    s32 compare_command_move_archetypes(const Command_Move& lhs, const Command_Move& rhs){
+        if(lhs.src_arch_index != rhs.src_arch_index) return (lhs.src_arch_index > rhs.src_arch_index) - (lhs.src_arch_index < rhs.src_arch_index);
+        return (lhs.dst_arch_index > rhs.dst_arch_index) - (lhs.dst_arch_index < rhs.dst_arch_index);
+    }
+
+    s32 compare_command_move_indices(const Command_Move& lhs, const Command_Move& rhs){
+        return comparison_increasing_order(lhs.src_index, rhs.src_index);
+    }
+
+    struct System_Parallel_Context{
+        const System* system;
+        const System_Param* params;
+    };
+
+    static void system_parallel_job(void* data, u32 ijob, u32 iworker){
+        System_Parallel_Context* context = (System_Parallel_Context*)data;
+
+        // NOTE(hugo): each worker gets its own copy of the param
+        System_Param param = context->params[ijob];
+        param.iworker = iworker;
+
+        context->system->update(context->system->data, param);
     }
 
-    void execute_system(Manager& manager, const System& system){
+    // NOTE(hugo): /version/ is the version written to the chunks
+    static void execute_system_version(Manager& manager, const System& system, Worker_Pool* pool, u32 version){
+        bool parallel = system.parallel && pool && pool->nworkers > 1u;
+
         System_Param param;
+        param.iworker = 0u;
+
+        if(parallel) manager.parallel_params.clear();
+
+        auto process_chunk = [&](){
+            if(parallel)    manager.parallel_params.push(param);
+            else            system.update(system.data, param);
+        };
+
+        // NOTE(hugo): versions are compared with wrapping arithmetic
+        auto chunk_changed = [&](const u32* chunk_versions, const u16* type_indices){
+            for(u32 isys = 0u; isys != system.ntypes; ++isys){
+                if((system.changed_mask & (1u << isys))
+                && (s32)(chunk_versions[type_indices[isys]] - system.changed_since) > 0){
+                    return true;
+                }
+            }
+            return false;
+        };
+
+        auto process_archetype = [&](const Archetype& arch, Archetype_Storage& storage, const u16* type_indices){
+            for(u32 ichunk = 0u; ichunk != storage.chunks.size; ++ichunk){
+                u32* chunk_versions = storage.versions.data + ichunk * arch.ntypes;
+
+                if(system.changed_mask && !chunk_changed(chunk_versions, type_indices)) continue;
+
+                for(u32 isys = 0u; isys != system.ntypes; ++isys){
+                    if(system.write_mask & (1u << isys)) chunk_versions[type_indices[isys]] = version;
+                }
+
+                // NOTE(hugo): the last chunk is partial
+                param.chunk = storage.chunks[ichunk];
+                param.nentities = (ichunk + 1u == storage.chunks.size) ? arch.entities_per_chunk - storage.free : arch.entities_per_chunk;
+                process_chunk();
+            }
+        };
+
+        if(system.query){
+            for(auto& match : system.query->matches){
+                Archetype_Storage& storage = manager.storage[match.arch_index];
+                if(!storage.nentities) continue;
+
+                memcpy(param.type_offsets, match.type_offsets, sizeof(match.type_offsets));
+                process_archetype(manager.archetypes[match.arch_index], storage, match.type_indices);
+            }
 
-        for(u32 iarch = 0u; iarch != manager.archetypes.size; ++iarch){
-            Archetype& arch = manager.archetypes[iarch];
+        }else{
+            u16 type_indices[max_ntypes];
 
-            if(system_assess_archetype(system, arch, param)){
+            for(u32 iarch = 0u; iarch != manager.archetypes.size; ++iarch){
+                Archetype& arch = manager.archetypes[iarch];
                 Archetype_Storage& storage = manager.storage[iarch];
 
-                // NOTE(hugo): complete chunks
-                for(u32 ichunk = 1u; ichunk < storage.chunks.size; ++ichunk){
-                    param.chunk = storage.chunks[ichunk - 1u];
-                    param.nentities = arch.entities_per_chunk;
-                    system.update(system.data, param);
+                // NOTE(hugo): also skips deallocated archetypes
+                if(!storage.nentities) continue;
+
+                if(assess_archetype(system.mask, system.ntypes, system.type_IDs, arch, param.type_offsets, type_indices)){
+                    process_archetype(arch, storage, type_indices);
                 }
+            }
+        }
+
+        if(parallel){
+            System_Parallel_Context context;
+            context.system = &system;
+            context.params = manager.parallel_params.data;
+
+            // NOTE(hugo): one job per chunk ; returns when every chunk was processed
+            pool->execute(manager.parallel_params.size, system_parallel_job, &context);
+        }
+    }
+
+    void execute_system(Manager& manager, const System& system, Worker_Pool* pool){
+        execute_system_version(manager, system, pool, ++manager.version);
+    }
+
+    bool systems_conflict(const System& sysA, const System& sysB){
+        // NOTE(hugo): type_IDs are sorted in both systems
+        u32 itypeA = 0u;
+        u32 itypeB = 0u;
+        while(itypeA != sysA.ntypes && itypeB != sysB.ntypes){
+            if(sysA.type_IDs[itypeA] < sysB.type_IDs[itypeB]){
+                ++itypeA;
+            }else if(sysA.type_IDs[itypeA] > sysB.type_IDs[itypeB]){
+                ++itypeB;
+            }else{
+                if((sysA.write_mask & (1u << itypeA)) || (sysB.write_mask & (1u << itypeB))) return true;
+                ++itypeA;
+                ++itypeB;
+            }
+        }
+        return false;
+    }
 
-                // NOTE(hugo): partial chunk at the end
-                if(storage.chunks.size){
-                    param.chunk = storage.chunks[storage.chunks.size - 1u];
-                    param.nentities = arch.entities_per_chunk - storage.free;
-                    system.update(system.data, param);
+    void Scheduler::create(){
+        systems.create();
+        levels.create();
+        order.create();
+        nlevels = 0u;
+        trace.create();
+    }
+
+    void Scheduler::destroy(){
+        systems.destroy();
+        levels.destroy();
+        order.destroy();
+        trace.destroy();
+    }
+
+    u32 Scheduler::add_system(const System* system){
+        u32 index = systems.size;
+        systems.push(system);
+        return index;
+    }
+
+    void Scheduler::clear(){
+        systems.clear();
+        levels.clear();
+        order.clear();
+        nlevels = 0u;
+        trace.clear();
+    }
+
+    void Scheduler::build_levels(){
+        // NOTE(hugo): a system is placed after every previously added system it conflicts with
+        levels.resize(systems.size);
+        nlevels = 0u;
+        for(u32 isystem = 0u; isystem != systems.size; ++isystem){
+            u32 level = 0u;
+            for(u32 iprevious = 0u; iprevious != isystem; ++iprevious){
+                if(levels[iprevious] >= level && systems_conflict(*systems[isystem], *systems[iprevious])){
+                    level = levels[iprevious] + 1u;
                 }
             }
+            levels[isystem] = level;
+            nlevels = max(nlevels, level + 1u);
+        }
+
+        // NOTE(hugo): counting sort by level ; systems of a level keep their insertion order
+        order.resize(systems.size);
+        u32 iorder = 0u;
+        for(u32 ilevel = 0u; ilevel != nlevels; ++ilevel){
+            for(u32 isystem = 0u; isystem != systems.size; ++isystem){
+                if(levels[isystem] == ilevel) order[iorder++] = isystem;
+            }
+        }
+    }
+
+    struct Scheduler_Context{
+        Scheduler* scheduler;
+        Manager* manager;
+        u32 level_begin;
+        u32 version;
+    };
+
+    static void scheduler_execute_system(Scheduler& scheduler, Manager& manager, u32 iorder, Worker_Pool* pool, u32 iworker, u32 version){
+        u32 isystem = scheduler.order[iorder];
+
+        Schedule_Trace& entry = scheduler.trace[iorder];
+        entry.isystem = isystem;
+        entry.level = scheduler.levels[isystem];
+        entry.iworker = iworker;
+        entry.start_ticks = timer_ticks();
+
+        execute_system_version(manager, *scheduler.systems[isystem], pool, version);
+
+        entry.end_ticks = timer_ticks();
+    }
+
+    static void scheduler_job(void* data, u32 ijob, u32 iworker){
+        Scheduler_Context* context = (Scheduler_Context*)data;
+
+        // NOTE(hugo): systems of a level are executed serially by their worker
+        scheduler_execute_system(*context->scheduler, *context->manager, context->level_begin + ijob, nullptr, iworker, context->version);
+    }
+
+    void Scheduler::execute(Manager& manager, Worker_Pool* pool){
+        build_levels();
+        trace.resize(systems.size);
+
+        u32 level_begin = 0u;
+        while(level_begin != order.size){
+            u32 level = levels[order[level_begin]];
+            u32 level_end = level_begin + 1u;
+            while(level_end != order.size && levels[order[level_end]] == level) ++level_end;
+
+            u32 version = ++manager.version;
+
+            if(level_end - level_begin == 1u){
+                // NOTE(hugo): the pool is available for the chunks of a parallel system
+                scheduler_execute_system(*this, manager, level_begin, pool, 0u, version);
+
+            }else if(pool && pool->nworkers > 1u){
+                Scheduler_Context context;
+                context.scheduler = this;
+                context.manager = &manager;
+                context.level_begin = level_begin;
+                context.version = version;
+
+                pool->execute(level_end - level_begin, scheduler_job, &context);
+
+            }else{
+                for(u32 iorder = level_begin; iorder != level_end; ++iorder){
+                    scheduler_execute_system(*this, manager, iorder, nullptr, 0u, version);
+                }
+            }
+
+            level_begin = level_end;
+        }
+    }
+
+    void Scheduler::log_trace() const{
+        LOG_INFO("scheduler trace: %d systems in %d levels", (u32)trace.size, nlevels);
+
+        u64 frame_start = trace.size ? trace[0u].start_ticks : 0u;
+        for(auto& entry : trace){
+            LOG_INFO("level: %d system: %d worker: %d start: %" PRId64 " duration: %" PRId64,
+                    entry.level, entry.isystem, entry.iworker,
+                    entry.start_ticks - frame_start, entry.end_ticks - entry.start_ticks);
         }
     }
 }
@@ -422,6 +1226,10 @@ namespace archecs::unit_test{
     struct Component_vec2{
         vec2 value;
     };
+    template<u32 index>
+    struct Component_Index{
+        u32 value;
+    };
 };
 
 void archecs_unit_test(){
@@ -485,6 +1293,483 @@ void archecs_unit_test(){
         manager.destroy_entity(entity);
     }
 
+    {
+        archecs::Manager& ecs_manager = manager.ecs_manager;
+        archecs::Archetype archetype = manager.create_archetype<Component_u32>();
+
+        u32 arch_index = get_archetype(ecs_manager, archetype);
+        assert(search_archetype(ecs_manager, archetype) == arch_index);
+
+        u32 with_index = get_archetype_with_type(ecs_manager, manager.type_metadata, arch_index, 2u);
+        assert(with_index != arch_index);
+        assert(search_type(ecs_manager.archetypes[with_index], 2u) != -1);
+        assert(get_archetype_with_type(ecs_manager, manager.type_metadata, arch_index, 2u) == with_index);
+        assert(get_archetype_without_type(ecs_manager, manager.type_metadata, with_index, 2u) == arch_index);
+        assert(get_archetype_with_type(ecs_manager, manager.type_metadata, with_index, 2u) == with_index);
+    }
+
+    {
+        // NOTE(hugo): the entity swapped into the vacated slot must remain reachable
+        archecs::Archetype archetype = manager.create_archetype<Component_u32>();
+        archecs::Entity_Handle entities[3];
+        for(u32 ientity = 0u; ientity != 3u; ++ientity){
+            entities[ientity] = manager.create_entity(archetype);
+            manager.get_data<Component_u32>(entities[ientity])->value = ientity;
+        }
+
+        manager.attach_data<Component_vec2>(entities[0]);
+        manager.detach_data<Component_u32>(entities[1]);
+
+        assert(manager.get_data<Component_u32>(entities[0])->value == 0u);
+        assert(!manager.available_data<Component_u32>(entities[1]));
+        assert(manager.get_data<Component_u32>(entities[2])->value == 2u);
+
+        for(u32 ientity = 0u; ientity != 3u; ++ientity){
+            archecs::Entity_Handle* storage_entity = manager.get_data<Entity_Handle>(entities[ientity]);
+            assert(storage_entity->virtual_index == entities[ientity].virtual_index);
+            manager.destroy_entity(entities[ientity]);
+        }
+    }
+
+    {
+        // NOTE(hugo): the query is updated with the archetypes allocated after its creation
+        archecs::Entity_Manager<Component_u32, Component_vec2> query_manager;
+        query_manager.create();
+
+        archecs::System system = query_manager.create_system<Component_vec2>();
+        query_manager.create_query(system);
+        assert(system.query->matches.size == 0u);
+
+        archecs::Archetype archetype = query_manager.create_archetype<Component_u32, Component_vec2>();
+        archecs::Entity_Handle entity = query_manager.create_entity(archetype);
+        assert(system.query->matches.size == 1u);
+
+        u32 arch_index = search_archetype(query_manager.ecs_manager, archetype);
+        assert(system.query->matches[0u].arch_index == arch_index);
+        assert(system.query->matches[0u].type_offsets[0u] == query_manager.ecs_manager.archetypes[arch_index].type_offsets[2u]);
+
+        query_manager.destroy_entity(entity);
+        query_manager.destroy_query(system);
+        assert(!system.query);
+
+        query_manager.destroy();
+    }
+
+    {
+        // NOTE(hugo): deferred commands
+        archecs::Archetype archetype = manager.create_archetype<Component_u32>();
+
+        archecs::Entity_Handle entities[8];
+        for(u32 ientity = 0u; ientity != 8u; ++ientity){
+            entities[ientity] = manager.create_entity(archetype);
+            manager.get_data<Component_u32>(entities[ientity])->value = ientity;
+        }
+
+        archecs::Entity_Handle deferred_entity = manager.defer_create_entity(archetype);
+        manager.defer_attach_data<Component_vec2>(deferred_entity);
+        assert(manager.available_entity(deferred_entity));
+        assert(!manager.get_data<Component_u32>(deferred_entity));
+
+        archecs::Entity_Handle cancelled_entity = manager.defer_create_entity(archetype);
+        manager.defer_destroy_entity(cancelled_entity);
+
+        for(u32 ientity = 0u; ientity != 8u; ientity += 2u) manager.defer_attach_data<Component_vec2>(entities[ientity]);
+        manager.defer_destroy_entity(entities[1]);
+        manager.defer_detach_data<Component_u32>(entities[3]);
+        manager.defer_attach_data<Component_vec2>(entities[5]);
+        manager.defer_detach_data<Component_vec2>(entities[5]);
+
+        manager.apply_commands();
+
+        assert(!manager.available_entity(cancelled_entity));
+        assert(!manager.available_entity(entities[1]));
+        assert(manager.available_data<Component_u32>(deferred_entity) && manager.available_data<Component_vec2>(deferred_entity));
+        assert(!manager.available_data<Component_u32>(entities[3]));
+        assert(!manager.available_data<Component_vec2>(entities[5]));
+
+        for(u32 ientity = 0u; ientity != 8u; ++ientity){
+            if(ientity == 1u) continue;
+
+            if(ientity != 3u) assert(manager.get_data<Component_u32>(entities[ientity])->value == ientity);
+            assert(manager.available_data<Component_vec2>(entities[ientity]) == (ientity % 2u == 0u));
+            assert(manager.get_data<Entity_Handle>(entities[ientity])->virtual_index == entities[ientity].virtual_index);
+            manager.destroy_entity(entities[ientity]);
+        }
+        manager.destroy_entity(deferred_entity);
+    }
+
+    {
+        // NOTE(hugo): bulk creation and destruction
+        archecs::Archetype archetype = manager.create_archetype<Component_u32, Component_vec2>();
+        u32 arch_index = get_archetype(manager.ecs_manager, archetype);
+        u32 entities_per_chunk = manager.ecs_manager.archetypes[arch_index].entities_per_chunk;
+
+        u32 nentities = 2u * entities_per_chunk + 1u;
+        archecs::Entity_Handle* entities = (archecs::Entity_Handle*)bw_malloc(sizeof(archecs::Entity_Handle) * nentities);
+        array<archecs::Entity_Range> ranges;
+        ranges.create();
+
+        manager.create_entities(archetype, nentities, entities, ranges);
+        assert(ranges.size == 3u);
+
+        u32 ientity = 0u;
+        for(auto& range : ranges){
+            Component_u32* cu32 = manager.range_data<Component_u32>(range);
+            Entity_Handle* handles = manager.range_data<Entity_Handle>(range);
+            for(u32 irange_entity = 0u; irange_entity != range.nentities; ++irange_entity){
+                cu32[irange_entity].value = ientity;
+                assert(handles[irange_entity].virtual_index == entities[ientity].virtual_index);
+                ++ientity;
+            }
+        }
+        assert(ientity == nentities);
+
+        for(u32 icheck = 0u; icheck != nentities; ++icheck){
+            assert(manager.get_data<Component_u32>(entities[icheck])->value == icheck);
+        }
+
+        // NOTE(hugo): destroy every other entity then the rest
+        array<archecs::Entity_Handle> to_destroy;
+        to_destroy.create();
+        for(u32 icheck = 0u; icheck < nentities; icheck += 2u) to_destroy.push(entities[icheck]);
+        manager.destroy_entities(to_destroy.data, to_destroy.size);
+
+        to_destroy.clear();
+        for(u32 icheck = 0u; icheck != nentities; ++icheck){
+            if(icheck % 2u == 0u){
+                assert(!manager.available_entity(entities[icheck]));
+            }else{
+                assert(manager.get_data<Component_u32>(entities[icheck])->value == icheck);
+                to_destroy.push(entities[icheck]);
+            }
+        }
+        manager.destroy_entities(to_destroy.data, to_destroy.size);
+        assert(manager.ecs_manager.storage[arch_index].nentities == 0u);
+
+        to_destroy.destroy();
+        ranges.destroy();
+        bw_free(entities);
+    }
+
+    {
+        // NOTE(hugo): change versions
+        archecs::Entity_Manager<Component_u32, Component_vec2> version_manager;
+        version_manager.create();
+
+        archecs::Archetype archetype = version_manager.create_archetype<Component_u32, Component_vec2>();
+        u32 arch_index = get_archetype(version_manager.ecs_manager, archetype);
+        u32 entities_per_chunk = version_manager.ecs_manager.archetypes[arch_index].entities_per_chunk;
+
+        u32 nentities = 2u * entities_per_chunk;
+        archecs::Entity_Handle* entities = (archecs::Entity_Handle*)bw_malloc(sizeof(archecs::Entity_Handle) * nentities);
+        array<archecs::Entity_Range> ranges;
+        ranges.create();
+        version_manager.create_entities(archetype, nentities, entities, ranges);
+
+        u32 nvisited = 0u;
+        auto count_chunks = [](void* data, const archecs::System_Param&){
+            ++*(u32*)data;
+        };
+
+        archecs::System system_write = version_manager.create_system<Write<Component_u32>, Read<Component_vec2>>();
+        system_write.data = &nvisited;
+        system_write.update = count_chunks;
+        assert(system_write.write_mask == 0x1u);
+
+        archecs::System system_read = version_manager.create_system<Read<Component_u32>>();
+        system_read.data = &nvisited;
+        system_read.update = count_chunks;
+        assert(system_read.write_mask == 0u);
+
+        // NOTE(hugo): everything changed since creation
+        version_manager.filter_changed<Component_u32>(system_read, version_manager.current_version());
+        version_manager.execute_system(system_read);
+        assert(nvisited == 2u);
+
+        // NOTE(hugo): nothing changed
+        nvisited = 0u;
+        version_manager.filter_changed<Component_u32>(system_read, version_manager.current_version());
+        version_manager.execute_system(system_read);
+        assert(nvisited == 0u);
+
+        // NOTE(hugo): written by system_write
+        version_manager.execute_system(system_write);
+        nvisited = 0u;
+        version_manager.execute_system(system_read);
+        assert(nvisited == 2u);
+
+        // NOTE(hugo): the vec2 filter ignores the u32 writes
+        archecs::System system_vec2 = version_manager.create_system<Read<Component_vec2>>();
+        system_vec2.data = &nvisited;
+        system_vec2.update = count_chunks;
+        version_manager.filter_changed<Component_vec2>(system_vec2, version_manager.current_version());
+        version_manager.execute_system(system_write);
+        nvisited = 0u;
+        version_manager.execute_system(system_vec2);
+        assert(nvisited == 0u);
+
+        // NOTE(hugo): structural changes only mark the chunks they modify
+        version_manager.filter_changed<Component_u32>(system_read, version_manager.current_version());
+        version_manager.destroy_entity(entities[0u]);
+        nvisited = 0u;
+        version_manager.execute_system(system_read);
+        assert(nvisited == 1u);
+
+        version_manager.destroy_entities(entities + 1u, nentities - 1u);
+        ranges.destroy();
+        bw_free(entities);
+        version_manager.destroy();
+    }
+
+    {
+        // NOTE(hugo): scheduler levels
+        archecs::System system_write_u32 = manager.create_system<Write<Component_u32>>();
+        archecs::System system_read_u32_vec2 = manager.create_system<Read<Component_u32>, Read<Component_vec2>>();
+        archecs::System system_write_vec2 = manager.create_system<Write<Component_vec2>>();
+        archecs::System system_read_u32_only = manager.create_system<Read<Component_u32>>();
+
+        u32 nexecuted = 0u;
+        auto count_execution = [](void* data, const archecs::System_Param&){
+            ++*(u32*)data;
+        };
+        archecs::System* systems[] = {&system_write_u32, &system_read_u32_vec2, &system_write_vec2, &system_read_u32_only};
+        for(auto& system : systems){
+            system->data = &nexecuted;
+            system->update = count_execution;
+        }
+
+        assert(systems_conflict(system_write_u32, system_read_u32_vec2));
+        assert(!systems_conflict(system_read_u32_vec2, system_read_u32_only));
+
+        archecs::Scheduler scheduler;
+        scheduler.create();
+        for(auto& system : systems) scheduler.add_system(system);
+
+        archecs::Archetype archetype = manager.create_archetype<Component_u32, Component_vec2>();
+        archecs::Entity_Handle entity = manager.create_entity(archetype);
+
+        manager.execute_scheduler(scheduler);
+
+        assert(scheduler.nlevels == 3u);
+        assert(scheduler.levels[0u] == 0u);
+        assert(scheduler.levels[1u] == 1u);
+        assert(scheduler.levels[2u] == 2u);
+        assert(scheduler.levels[3u] == 1u);
+        assert(scheduler.trace.size == 4u);
+        assert(nexecuted == 4u);
+
+        manager.destroy_entity(entity);
+        scheduler.destroy();
+    }
+
+    {
+        // NOTE(hugo): compaction
+        archecs::Entity_Manager<Component_u32, Component_vec2> fragmented_manager;
+        fragmented_manager.create();
+
+        archecs::Archetype archetype = fragmented_manager.create_archetype<Component_u32, Component_vec2>();
+        constexpr u32 nentities = 100000u;
+        archecs::Entity_Handle* entities = (archecs::Entity_Handle*)bw_malloc(sizeof(archecs::Entity_Handle) * nentities);
+        array<Entity_Range> ranges;
+        ranges.create();
+
+        fragmented_manager.create_entities(archetype, nentities, entities, ranges);
+        u32 nchunks = ranges.size;
+        fragmented_manager.destroy_entities(entities, nentities);
+        assert(fragmented_manager.ecs_manager.nfree_chunks == nchunks);
+
+        const Block_Pool& chunk_pool = fragmented_manager.ecs_manager.chunk_pool;
+        size_t slab_bytesize = chunk_pool.slab_bytesize;
+        u32 nslabs = chunk_pool.nslabs;
+        assert(nslabs >= 4u);
+        for(u32 irange = 0u; irange != ranges.size; ++irange) assert(((uintptr_t)ranges[irange].chunk % cache_line_bytesize) == 0u);
+
+        // NOTE(hugo): a spent tick budget releases nothing
+        size_t released = fragmented_manager.compact(2u, SIZE_MAX, 0u);
+        assert(released == 0u);
+        assert(fragmented_manager.ecs_manager.nfree_chunks == nchunks && chunk_pool.nreleased_slabs == 0u);
+
+        // NOTE(hugo): the byte budget stops the compaction ie the surplus chunks return to the pool and a single slab is released
+        released = fragmented_manager.compact(2u, slab_bytesize, UINT64_MAX);
+        assert(released == slab_bytesize);
+        assert(fragmented_manager.ecs_manager.nfree_chunks == 2u);
+        assert(chunk_pool.nreleased_slabs == 1u);
+
+        // NOTE(hugo): the kept chunks are in at most two slabs
+        released = fragmented_manager.compact(2u, SIZE_MAX, UINT64_MAX);
+        assert(released >= (nslabs - 3u) * slab_bytesize);
+        assert(chunk_pool.committed_bytesize() <= 2u * slab_bytesize);
+        released = fragmented_manager.compact(2u, SIZE_MAX, UINT64_MAX);
+        assert(released == 0u);
+
+        // NOTE(hugo): the kept chunks are reused
+        ranges.clear();
+        fragmented_manager.create_entities(archetype, nentities, entities, ranges);
+        assert(fragmented_manager.ecs_manager.nfree_chunks == 0u);
+        for(u32 ientity = 0u; ientity != nentities; ++ientity) assert(fragmented_manager.available_data<Component_u32>(entities[ientity]));
+
+        fragmented_manager.destroy_entities(entities, nentities);
+        ranges.destroy();
+        bw_free(entities);
+        fragmented_manager.destroy();
+    }
+
+    {
+        // NOTE(hugo): more than 15 types per archetype
+        using Wide_Manager = archecs::Entity_Manager<
+            Component_Index<0u>,  Component_Index<1u>,  Component_Index<2u>,  Component_Index<3u>,  Component_Index<4u>,
+            Component_Index<5u>,  Component_Index<6u>,  Component_Index<7u>,  Component_Index<8u>,  Component_Index<9u>,
+            Component_Index<10u>, Component_Index<11u>, Component_Index<12u>, Component_Index<13u>, Component_Index<14u>,
+            Component_Index<15u>, Component_Index<16u>, Component_Index<17u>, Component_Index<18u>, Component_Index<19u>>;
+        Wide_Manager wide_manager;
+        wide_manager.create();
+
+        archecs::Archetype archetype = wide_manager.create_archetype<Component_Index<19u>, Component_Index<3u>>();
+        assert(archetype.type_IDs[1u] == 4u && archetype.type_IDs[2u] == 20u);
+        for(u32 itype = 1u; itype != 20u; ++itype) add_type(wide_manager.ecs_manager, wide_manager.type_metadata, archetype, itype);
+        assert(archetype.ntypes == 21u);
+        assert(search_type(archetype, 17u) == 17);
+
+        archecs::Entity_Handle entity = wide_manager.create_entity(archetype);
+        wide_manager.get_data<Component_Index<19u>>(entity)->value = 19u;
+        wide_manager.get_data<Component_Index<0u>>(entity)->value = 0u;
+
+        wide_manager.detach_data<Component_Index<10u>>(entity);
+        assert(!wide_manager.available_data<Component_Index<10u>>(entity));
+        assert(wide_manager.get_data<Component_Index<19u>>(entity)->value == 19u);
+        wide_manager.attach_data<Component_Index<10u>>(entity);
+        assert(wide_manager.available_data<Component_Index<10u>>(entity));
+        assert(wide_manager.get_data<Component_Index<19u>>(entity)->value == 19u);
+        assert(wide_manager.get_data<Component_Index<0u>>(entity)->value == 0u);
+
+        // NOTE(hugo): the archetype is found again through its signature
+        assert(search_archetype(wide_manager.ecs_manager, archetype) != UINT32_MAX);
+
+        u32 nvisited = 0u;
+        archecs::System system = wide_manager.create_system<Write<Component_Index<19u>>, Read<Component_Index<2u>>>();
+        assert(system.write_mask == 0x2u);
+        system.data = &nvisited;
+        system.update = [](void* data, const archecs::System_Param& param){
+            Component_Index<19u>* values = (Component_Index<19u>*)(param.chunk->data + param.type_offsets[1u]);
+            assert(values[0u].value == 19u);
+            *(u32*)data += param.nentities;
+        };
+        wide_manager.execute_system(system);
+        assert(nvisited == 1u);
+
+        wide_manager.destroy_entity(entity);
+        wide_manager.destroy();
+    }
+
+    {
+        // NOTE(hugo): snapshot round trip
+        archecs::Entity_Manager<Component_u32, Component_vec2> save_manager;
+        save_manager.create();
+
+        archecs::Archetype archetype = save_manager.create_archetype<Component_u32, Component_vec2>();
+        constexpr u32 nentities = 3000u;
+        archecs::Entity_Handle* entities = (archecs::Entity_Handle*)bw_malloc(sizeof(archecs::Entity_Handle) * nentities);
+        for(u32 ientity = 0u; ientity != nentities; ++ientity){
+            entities[ientity] = save_manager.create_entity(archetype);
+            save_manager.get_data<Component_u32>(entities[ientity])->value = ientity;
+        }
+
+        // NOTE(hugo): an empty archetype and an inactive handle
+        archecs::Entity_Handle temporary = save_manager.create_entity(save_manager.create_archetype<Component_vec2>());
+        save_manager.destroy_entity(temporary);
+        save_manager.destroy_entity(entities[0u]);
+
+        File_Path path;
+        path = "archecs_snapshot.bin";
+        bool saved = save_manager.save_snapshot(path);
+        assert(saved);
+
+        archecs::Entity_Manager<Component_u32, Component_vec2> load_manager;
+        load_manager.create();
+
+        u32 nvisited = 0u;
+        archecs::System system = load_manager.create_system<Read<Component_u32>>();
+        system.data = &nvisited;
+        system.update = [](void* data, const archecs::System_Param& param){
+            *(u32*)data += param.nentities;
+        };
+        load_manager.create_query(system);
+
+        bool loaded = load_manager.load_snapshot(path);
+        assert(loaded);
+
+        // NOTE(hugo): saving onto the mapped file then loading it again ; windows refuses to replace the mapped file and keeps it as is
+        saved = load_manager.save_snapshot(path);
+#if defined(PLATFORM_WINDOWS)
+        assert(!saved);
+#else
+        assert(saved);
+#endif
+        loaded = load_manager.load_snapshot(path);
+        assert(loaded);
+
+        // NOTE(hugo): a snapshot with inconsistent counts or contents is rejected and the manager is left untouched
+        FILE* snapshot_file = fopen(path.data, "rb");
+        assert(snapshot_file);
+        archecs::Snapshot_Header header;
+        size_t nread = fread(&header, sizeof(archecs::Snapshot_Header), 1u, snapshot_file);
+        assert(nread == 1u);
+        fclose(snapshot_file);
+        archecs::Snapshot_Layout layout = archecs::snapshot_layout(header);
+
+        typedef indexmap<Entity>::mapping Entity_Mapping;
+        struct{
+            size_t offset;
+            u32 value;
+        } corruptions[] = {
+            {offsetof(archecs::Snapshot_Header, nversions), 0u},
+            {offsetof(archecs::Snapshot_Header, nchunks), 1u},
+            {layout.archetypes_offset + offsetof(archecs::Archetype, entities_per_chunk), 1u},
+            {layout.storage_offset + offsetof(archecs::Snapshot_Storage, nentities), UINT32_MAX},
+            {layout.entity_map_offset + (entities[1u].virtual_index - 1u) * sizeof(Entity_Mapping) + offsetof(Entity_Mapping, active.type.archetype_index), header.narchetypes},
+        };
+        for(auto& corruption : corruptions){
+            snapshot_file = fopen(path.data, "r+b");
+            assert(snapshot_file);
+            u32 previous;
+            fseek(snapshot_file, (long)corruption.offset, SEEK_SET);
+            nread = fread(&previous, sizeof(u32), 1u, snapshot_file);
+            assert(nread == 1u);
+            fseek(snapshot_file, (long)corruption.offset, SEEK_SET);
+            fwrite(&corruption.value, sizeof(u32), 1u, snapshot_file);
+            fflush(snapshot_file);
+
+            loaded = load_manager.load_snapshot(path);
+            assert(!loaded);
+
+            fseek(snapshot_file, (long)corruption.offset, SEEK_SET);
+            fwrite(&previous, sizeof(u32), 1u, snapshot_file);
+            fclose(snapshot_file);
+        }
+        remove(path.data);
+
+        assert(!load_manager.available_entity(entities[0u]));
+        assert(!load_manager.available_entity(temporary));
+        for(u32 ientity = 1u; ientity != nentities; ++ientity){
+            assert(load_manager.available_entity(entities[ientity]));
+            assert(load_manager.get_data<Component_u32>(entities[ientity])->value == ientity);
+            assert(load_manager.get_data<Entity_Handle>(entities[ientity])->virtual_index == entities[ientity].virtual_index);
+        }
+
+        load_manager.execute_system(system);
+        assert(nvisited == nentities - 1u);
+
+        // NOTE(hugo): the loaded manager keeps working with chunks from the mapping and new chunks
+        for(u32 ientity = 1u; ientity != nentities / 2u; ++ientity) load_manager.destroy_entity(entities[ientity]);
+        archecs::Entity_Handle created = load_manager.create_entity(load_manager.create_archetype<Component_u32>());
+        load_manager.attach_data<Component_vec2>(created);
+        assert(load_manager.available_data<Component_vec2>(created));
+
+        load_manager.destroy();
+        save_manager.destroy();
+        bw_free(entities);
+    }
+
     manager.destroy();
 }
 
@@ -14,7 +14,12 @@
 
 namespace archecs{
     constexpr size_t chunk_bytesize = KILOBYTES(16u);
-    constexpr u32 max_ntypes = 15u;
+    // NOTE(hugo): chunks are allocated from Manager::chunk_pool in slabs of chunks_per_slab chunks
+    constexpr u32 chunks_per_slab = 16u;
+    // NOTE(hugo): number of types of an Entity_Manager including Entity_Handle
+    constexpr u32 max_types = 128u;
+    // NOTE(hugo): number of types of an archetype or a system
+    constexpr u32 max_ntypes = 32u;
     constexpr u32 infinite_entities_per_chunk = UINT32_MAX;
 
     struct Type_Metadata{
@@ -37,33 +42,117 @@ namespace archecs{
         u32 nentities;
         u32 free;
         array<Chunk*> chunks;
+
+        // NOTE(hugo): version of the last write to each type of each chunk ie versions[ichunk * ntypes + itype]
+        array<u32> versions;
+    };
+
+    // NOTE(hugo): bit /type_ID/ is set when the type is present
+    struct Type_Mask{
+        u64 words[max_types / 64u];
     };
 
+    DECLARE_EQUALITY_OPERATOR(Type_Mask)
+
+    Type_Mask type_mask(const u16* type_IDs, u32 ntypes);
+    void type_mask_set(Type_Mask& mask, u32 type_ID);
+    void type_mask_unset(Type_Mask& mask, u32 type_ID);
+    bool type_mask_test(const Type_Mask& mask, u32 type_ID);
+    // NOTE(hugo): number of types in /mask/ with a smaller type_ID ie index of /type_ID/ in the sorted type_IDs
+    u32 type_mask_rank(const Type_Mask& mask, u32 type_ID);
+    bool type_mask_contains(const Type_Mask& mask, const Type_Mask& subset);
+
+    // NOTE(hugo): type_IDs are sorted ie the index of a type is type_mask_rank(mask, type_ID)
     struct Archetype{
+        Type_Mask mask;
         u16 ntypes;
         u16 type_IDs[max_ntypes];
         u16 type_offsets[max_ntypes];
         u32 entities_per_chunk;
     };
 
-    struct Manager{
-        array<Archetype> archetypes;
-        array<Archetype_Storage> storage;
-        Archetype* free_archetype_head;
-        Chunk* free_chunk_head;
+    // NOTE(hugo): /nentities/ contiguous entities of an archetype starting at /first/ in /chunk/
+    struct Entity_Range{
+        u32 arch_index;
+        Chunk* chunk;
+        u32 first;
+        u32 nentities;
     };
 
+    // NOTE(hugo): identifies an archetype
+    typedef Type_Mask Archetype_Signature;
+
+    u32 hashmap_hash(const Archetype_Signature& signature);
+
     struct System_Param{
         Chunk* chunk;
         u32 nentities;
         u16 type_offsets[max_ntypes];
+
+        // NOTE(hugo): index of the worker executing the update ; 0 when executed serially
+        u32 iworker;
+    };
+
+    struct Query_Match{
+        u32 arch_index;
+        u16 type_offsets[max_ntypes];
+        u16 type_indices[max_ntypes];
+    };
+
+    // NOTE(hugo): archetypes matching a system ; updated by allocate_archetype
+    struct Query{
+        Type_Mask mask;
+        u16 ntypes;
+        u16 type_IDs[max_ntypes];
+        array<Query_Match> matches;
+    };
+
+    struct Manager{
+        array<Archetype> archetypes;
+        array<Archetype_Storage> storage;
+        Chunk* free_chunk_head;
+        u32 nfree_chunks;
+        Block_Pool chunk_pool;
+
+        // NOTE(hugo): signature -> archetype index
+        hashmap<Archetype_Signature, u32> archetype_map;
+        // NOTE(hugo): (archetype index, type_ID, add or remove) -> archetype index
+        hashmap<u64, u32> archetype_edges;
+
+        // NOTE(hugo): chunks of the system being executed in parallel ; kept to avoid allocating on every execution
+        array<System_Param> parallel_params;
+
+        // NOTE(hugo): owned by the manager ; destroyed by destroy_manager when not destroyed before
+        array<Query*> queries;
+
+        // NOTE(hugo): incremented by every execute_system
+        u32 version;
+
+        // NOTE(hugo): mapping of the last loaded snapshot ; its chunks point in the mapping and are never returned to the chunk pool
+        File_Mapping snapshot;
+        File_Path snapshot_path;
     };
 
     struct System{
+        Type_Mask mask;
         u16 ntypes;
         u16 type_IDs[max_ntypes];
         void* data;
         void (*update)(void* data, const System_Param& param);
+
+        // NOTE(hugo): matching archetypes are read from the query when set instead of assessing every archetype
+        Query* query;
+
+        // NOTE(hugo): bit /isys/ is set when the system writes type_IDs[isys] ; the versions of the visited chunks are bumped for those types
+        u32 write_mask;
+
+        // NOTE(hugo): when non-zero only the chunks where one of those types changed after /changed_since/ are visited
+        u32 changed_mask;
+        u32 changed_since;
+
+        // NOTE(hugo): chunks are distributed to the worker pool when set
+        // /!\ update is then called concurrently /!\ it must not write to shared state without synchronization
+        bool parallel;
     };
 
     // NOTE(hugo): returns the index of type_ID in the archetype
@@ -74,27 +163,112 @@ namespace archecs{
 
     s32 search_type(const Archetype& archetype, u32 type_ID);
 
-    u32 allocate_archetype(Manager& man);
-    void deallocate_archetype(Manager& man, u32 arch_index);
+    Archetype_Signature archetype_signature(const Archetype& archetype);
+
+    // NOTE(hugo): registers the archetype in the archetype_map
+    u32 allocate_archetype(Manager& man, const Archetype& arch);
+
+    // NOTE(hugo): returns UINT32_MAX when the archetype is not registered
+    u32 search_archetype(const Manager& man, const Archetype& arch);
+    u32 get_archetype(Manager& man, const Archetype& arch);
+
+    // NOTE(hugo): follows the cached edge or creates it ; returns /arch_index/ when the archetype already has / does not have /type_ID/
+    u32 get_archetype_with_type(Manager& man, const Type_Metadata* type_metadata, u32 arch_index, u32 type_ID);
+    u32 get_archetype_without_type(Manager& man, const Type_Metadata* type_metadata, u32 arch_index, u32 type_ID);
 
     // NOTE(hugo): returns the index of the entity
     u32 allocate_entity_storage(Manager& man, const Archetype& arch, Archetype_Storage& storage);
+    // NOTE(hugo): returns the index of the first entity ; the /count/ entities are contiguous
+    u32 allocate_entities_storage(Manager& man, const Archetype& arch, Archetype_Storage& storage, u32 count);
     // NOTE(hugo): returns the index of the entity that got moved to /index/ ; or /index/ if no entity was moved
     u32 deallocate_entity_storage(Manager& man, const Type_Metadata* metadata, const Archetype& arch, Archetype_Storage& storage, u32 index);
 
     Entity allocate_entity(Manager& manager, const Archetype& arch);
+    Entity allocate_entity(Manager& manager, u32 arch_index);
     // NOTE(hugo): returns the index of the entity that got moved to /index/ ; or /index/ if no entity was moved
+    // empty archetypes are kept alive so that the archetype_map and archetype_edges remain valid
     u32 deallocate_entity(Manager& manager, const Type_Metadata* metadata, Entity entity);
 
-    Entity attach_type(Manager& manager, const Type_Metadata* type_metadata, Entity entity, u32 type_ID);
-    Entity detach_type(Manager& manager, const Type_Metadata* type_metadata, Entity entity, u32 type_ID);
+    // NOTE(hugo): splits the /count/ entities starting at /first/ into one range per chunk and pushes them to /ranges/
+    void get_entity_ranges(const Manager& man, u32 arch_index, u32 first, u32 count, array<Entity_Range>& ranges);
+    // NOTE(hugo): returns nullptr when the archetype does not have /type_ID/
+    void* range_memory(const Manager& man, const Type_Metadata* type_metadata, const Entity_Range& range, u32 type_ID);
+
+    // NOTE(hugo): copies the types shared by both archetypes from the /src_indices/ entities to the /count/ contiguous entities starting at /dst_first/
+    //             runs of contiguous /src_indices/ are copied with a single memcpy per type
+    void copy_entities(Manager& man, const Type_Metadata* type_metadata, u32 src_arch_index, const u32* src_indices, u32 count, u32 dst_arch_index, u32 dst_first);
+
+    // NOTE(hugo): /moved_index/ is the index of the entity that got moved to /entity.index/ ; or /entity.index/ if no entity was moved
+    Entity attach_type(Manager& manager, const Type_Metadata* type_metadata, Entity entity, u32 type_ID, u32& moved_index);
+    Entity detach_type(Manager& manager, const Type_Metadata* type_metadata, Entity entity, u32 type_ID, u32& moved_index);
     void* type_memory(Manager& manager, const Type_Metadata* type_metadata, Entity entity, u32 type_ID);
 
     void create_manager(Manager& manager);
     void destroy_manager(Manager& manager);
 
+    // NOTE(hugo): the storage of an archetype is always dense ie only its last chunk can be partially filled
+    // compaction returns the free chunks above /nkeep_free_chunks/ to the chunk pool, releases its empty slabs and the chunk arrays of empty archetypes
+    // stops once /max_bytesize/ bytes were released or /max_ticks/ timer ticks elapsed ie can be called on idle frames until it returns 0
+    // returns the number of bytes released
+    size_t compact_manager(Manager& manager, u32 nkeep_free_chunks, size_t max_bytesize, u64 max_ticks);
+
+    // NOTE(hugo): flat binary file of the manager and the entity_map ; the chunks are written as is
+    // the file is written next to /path/ then renamed over it ie /path/ is kept as is on failure
+    // /!\ fails on windows when /path/ is the snapshot the manager was loaded from /!\ the file is mapped and can not be replaced
+    // loading maps the file and points the chunks in the mapping ie a few large copies instead of recreating every entity
+    // the types must be relocatable with memcpy ie no pointer to memory owned by the entity
+    bool save_snapshot(const Manager& manager, const Type_Metadata* type_metadata, u32 ntypes, const indexmap<Entity>& entity_map, const File_Path& path);
+    // NOTE(hugo): replaces the content of the manager and the entity_map ; the queries are kept and matched again
+    // both are left untouched when the file is not a snapshot of the same types or its archetypes, storage counts or entity_map are inconsistent
+    bool load_snapshot(Manager& manager, const Type_Metadata* type_metadata, u32 ntypes, indexmap<Entity>& entity_map, const File_Path& path);
+
     u32 system_assess_archetype(const System& sys, const Archetype& arch, System_Param& param);
-    void execute_system(Manager& man, const System& sys);
+
+    // NOTE(hugo): the query matches the archetypes allocated before and after its creation
+    Query* create_query(Manager& man, const System& sys);
+    void destroy_query(Manager& man, Query* query);
+    // NOTE(hugo): serial when /pool/ is nullptr or /sys.parallel/ is false
+    void execute_system(Manager& man, const System& sys, Worker_Pool* pool = nullptr);
+
+    // NOTE(hugo): two systems conflict when one of them writes a type accessed by the other
+    bool systems_conflict(const System& sysA, const System& sysB);
+
+    struct Schedule_Trace{
+        u32 isystem;
+        u32 level;
+        u32 iworker;
+        u64 start_ticks;
+        u64 end_ticks;
+    };
+
+    // NOTE(hugo): the systems are executed by levels ; a system is placed after every previously added system it conflicts with
+    // the systems of a level do not conflict and are executed concurrently on the worker pool, each system on a single worker
+    // a level with a single system can use the worker pool for its chunks when /system.parallel/ is set
+    struct Scheduler{
+        void create();
+        void destroy();
+
+        // NOTE(hugo): the system is referenced and must remain valid while it is scheduled ; returns the index of the system
+        u32 add_system(const System* system);
+        void clear();
+
+        // NOTE(hugo): rebuilds the levels from the current access declarations then executes every system
+        void execute(Manager& man, Worker_Pool* pool = nullptr);
+        void build_levels();
+
+        void log_trace() const;
+
+        // ---- data
+
+        array<const System*> systems;
+        array<u32> levels;
+        // NOTE(hugo): system indices sorted by level
+        array<u32> order;
+        u32 nlevels;
+
+        // NOTE(hugo): trace of the last execution ; trace[iorder] is the execution of systems[order[iorder]]
+        array<Schedule_Trace> trace;
+    };
 
     // ---- template wrapper
 
@@ -103,9 +277,47 @@ namespace archecs{
 
     struct Entity_Handle : indexmap_handle {};
 
+    // NOTE(hugo): access declaration for create_system ; untagged types are considered written
+    template<typename T>
+    struct Read{};
+    template<typename T>
+    struct Write{};
+
+    // NOTE(hugo): archetype_index of an entity created by a command that has not been applied yet
+    constexpr u32 pending_archetype_index = UINT32_MAX;
+    // NOTE(hugo): destination of an entity destroyed by a command
+    constexpr u32 destroyed_archetype_index = UINT32_MAX - 1u;
+
+    enum struct Command_Type : u32{
+        CREATE_ENTITY,
+        DESTROY_ENTITY,
+        ATTACH_TYPE,
+        DETACH_TYPE,
+    };
+
+    struct Command{
+        Command_Type type;
+        Entity_Handle handle;
+        // NOTE(hugo): index in command_archetypes for CREATE_ENTITY ; type_ID for ATTACH_TYPE and DETACH_TYPE
+        u32 data;
+    };
+
+    // NOTE(hugo): resolved transition of an entity when applying commands
+    struct Command_Move{
+        u32 src_arch_index;
+        u32 dst_arch_index;
+        u32 src_index;
+        Entity_Handle handle;
+    };
+
+    // NOTE(hugo): introsort comparisons used by apply_commands
+    s32 compare_command_move_archetypes(const Command_Move& lhs, const Command_Move& rhs);
+    s32 compare_command_move_indices(const Command_Move& lhs, const Command_Move& rhs);
+
     template<typename ... Types>
     struct Entity_Manager{
         static constexpr u32 type_index_Entity_Handle = 0u;
+        static_assert(1u + sizeof...(Types) <= max_types);
 
         void create();
         void destroy();
@@ -118,22 +330,69 @@ namespace archecs{
         Entity_Handle create_entity(const Archetype& archetype);
         void destroy_entity(const Entity_Handle entity_handle);
 
+        // NOTE(hugo): the entities fill the chunks contiguously ; /out_handles/ must hold /count/ handles
+        // one range per chunk is pushed to /out_ranges/ and the handles are in the same order as the ranges
+        void create_entities(const Archetype& archetype, u32 count, Entity_Handle* out_handles, array<Entity_Range>& out_ranges);
+        // NOTE(hugo): the entities are grouped by archetype and released in decreasing index order ; /entity_handles/ must be unique
+        void destroy_entities(const Entity_Handle* entity_handles, u32 count);
+
         template<typename T>
         void attach_data(const Entity_Handle entity_handle);
         template<typename T>
         void detach_data(const Entity_Handle entity_handle);
         template<typename T>
         T* get_data(const Entity_Handle entity_handle);
+        // NOTE(hugo): array of /range.nentities/ T ; nullptr when the range does not have T
+        template<typename T>
+        T* range_data(const Entity_Range& range);
 
         bool available_entity(const Entity_Handle entity_handle);
         template<typename T>
         bool available_data(const Entity_Handle entity_handle);
 
-        // NOTE(hugo): system.data and system.update must be modified after creation
+        // NOTE(hugo): fixes the entity_map after the entity at /moved_index/ was moved to /entity.index/
+        void update_moved_entity(const Entity entity, u32 moved_index);
+
+        // NOTE(hugo): system.data and system.update must be modified after creation ; system.parallel defaults to false
         template<typename ... System_Types>
         System create_system();
 
+        // NOTE(hugo): only visit the chunks where one of /Filter_Types/ changed after /version/ ie typically the version of the previous execution
+        template<typename ... Filter_Types>
+        void filter_changed(System& system, u32 version);
+        u32 current_version();
+
+        // NOTE(hugo): sets system.query ; the query is destroyed with the manager when not destroyed before
+        void create_query(System& system);
+        void destroy_query(System& system);
+
         void execute_system(const System& system);
+        void execute_scheduler(Scheduler& scheduler);
+
+        size_t compact(u32 nkeep_free_chunks, size_t max_bytesize, u64 max_ticks);
+
+        // NOTE(hugo): /!\ the deferred commands must be applied before /!\ pending entities are not part of the snapshot
+        bool save_snapshot(const File_Path& path);
+        bool load_snapshot(const File_Path& path);
+
+        // -- deferred commands
+        // NOTE(hugo): structural changes are recorded and applied by apply_commands() ie they can be recorded during a system update
+        // the handle of a deferred entity is valid immediately but its data is only available after apply_commands()
+        // /!\ recording is not thread-safe /!\ record from serial systems or from a single worker
+
+        Entity_Handle defer_create_entity(const Archetype& archetype);
+        void defer_destroy_entity(const Entity_Handle entity_handle);
+        template<typename T>
+        void defer_attach_data(const Entity_Handle entity_handle);
+        template<typename T>
+        void defer_detach_data(const Entity_Handle entity_handle);
+
+        // NOTE(hugo): entities are grouped by source and destination archetype and moved with bulk copies
+        // /!\ must not be called during a system update /!\ it modifies the chunks
+        void apply_commands();
+
+        // NOTE(hugo): /moves/ must be sorted with compare_command_move_archetypes
+        void apply_moves(Command_Move* moves, u32 nmoves);
 
         // ----
 
@@ -141,6 +400,12 @@ namespace archecs{
 
         Type_Metadata type_metadata[1u + sizeof...(Types)];
         Manager ecs_manager;
+
+        // NOTE(hugo): used by parallel systems ; nullptr executes every system serially
+        Worker_Pool* worker_pool;
+
+        array<Command> commands;
+        array<Archetype> command_archetypes;
     };
 }
 
@@ -1,4 +1,20 @@
 namespace archecs{
+    template<typename T>
+    struct system_access{
+        typedef T type;
+        static constexpr bool write = true;
+    };
+    template<typename T>
+    struct system_access<Read<T>>{
+        typedef T type;
+        static constexpr bool write = false;
+    };
+    template<typename T>
+    struct system_access<Write<T>>{
+        typedef T type;
+        static constexpr bool write = true;
+    };
+
     template<typename T>
     constexpr Type_Metadata metadataof(){
         return (Type_Metadata){sizeof(T), alignof(T), nullptr, nullptr};
@@ -12,24 +28,36 @@ namespace archecs{
 
         entity_map.create();
         create_manager(ecs_manager);
+
+        worker_pool = nullptr;
+
+        commands.create();
+        command_archetypes.create();
     }
 
     template<typename ... Types>
     void Entity_Manager<Types...>::destroy(){
         entity_map.destroy();
         destroy_manager(ecs_manager);
+
+        commands.destroy();
+        command_archetypes.destroy();
     }
 
     template<typename ... Types>
     template<typename ... Archetype_Types>
     Archetype Entity_Manager<Types...>::create_archetype(){
         Archetype archetype;
+        static_assert(1u + sizeof...(Archetype_Types) <= max_ntypes);
         archetype.ntypes = 1u + sizeof...(Archetype_Types);
 
         // NOTE(hugo): extract type ID
         constexpr u16 temp[] = { type_index_Entity_Handle, ((u16)type_index<Archetype_Types, Entity_Handle, Types...>()) ... };
         memcpy(archetype.type_IDs, temp, sizeof(temp));
 
+        isort(archetype.type_IDs, archetype.ntypes);
+        archetype.mask = type_mask(archetype.type_IDs, archetype.ntypes);
+
         update_archetype_metadata(ecs_manager, type_metadata, archetype);
 
         return archetype;
@@ -52,21 +80,78 @@ namespace archecs{
     void Entity_Manager<Types...>::destroy_entity(const Entity_Handle entity_handle){
         Entity* entity = entity_map.search(entity_handle);
 
+        if(entity && entity->archetype_index == pending_archetype_index){
+            LOG_WARNING("destroy_entity on pending entity ; use defer_destroy_entity");
+            return;
+        }
+
         if(entity){
             u32 moved_index = deallocate_entity(ecs_manager, type_metadata, *entity);
+            update_moved_entity(*entity, moved_index);
+
+            entity_map.return_handle(entity_handle);
+        }
+    }
+
+    template<typename ... Types>
+    void Entity_Manager<Types...>::create_entities(const Archetype& archetype, u32 count, Entity_Handle* out_handles, array<Entity_Range>& out_ranges){
+        if(!count) return;
+
+        u32 arch_index = get_archetype(ecs_manager, archetype);
+        u32 first = allocate_entities_storage(ecs_manager, ecs_manager.archetypes[arch_index], ecs_manager.storage[arch_index], count);
+
+        u32 first_range = out_ranges.size;
+        get_entity_ranges(ecs_manager, arch_index, first, count, out_ranges);
+
+        u32 ientity = 0u;
+        for(u32 irange = first_range; irange != out_ranges.size; ++irange){
+            Entity_Range& range = out_ranges[irange];
+            Entity_Handle* storage_handles = range_data<Entity_Handle>(range);
 
-            if(moved_index != entity->index){
-                Entity_Handle* moved_entity_handle = (Entity_Handle*)type_memory(ecs_manager, type_metadata, *entity, type_index_Entity_Handle);
-                assert(moved_entity_handle);
+            for(u32 irange_entity = 0u; irange_entity != range.nentities; ++irange_entity){
+                indexmap_handle handle = entity_map.borrow_handle();
 
-                Entity* moved_entity = entity_map.search(*moved_entity_handle);
-                assert(moved_entity);
+                Entity* entity = entity_map.search(handle);
+                entity->archetype_index = arch_index;
+                entity->index = first + ientity;
 
-                moved_entity->index = entity->index;
+                storage_handles[irange_entity] = (Entity_Handle){handle};
+                out_handles[ientity] = (Entity_Handle){handle};
+                ++ientity;
             }
+        }
+    }
 
-            entity_map.return_handle(entity_handle);
+    template<typename ... Types>
+    void Entity_Manager<Types...>::destroy_entities(const Entity_Handle* entity_handles, u32 count){
+        array<Command_Move> moves;
+        moves.create();
+        moves.reserve(count);
+
+        for(u32 ientity = 0u; ientity != count; ++ientity){
+            Entity* entity = entity_map.search(entity_handles[ientity]);
+
+            if(!entity){
+                LOG_WARNING("destroy_entities on unknown entity");
+                continue;
+            }
+            if(entity->archetype_index == pending_archetype_index){
+                LOG_WARNING("destroy_entities on pending entity ; use defer_destroy_entity");
+                continue;
+            }
+
+            Command_Move move;
+            move.src_arch_index = entity->archetype_index;
+            move.dst_arch_index = destroyed_archetype_index;
+            move.src_index = entity->index;
+            move.handle = entity_handles[ientity];
+            moves.push(move);
         }
+
+        introsort<Command_Move, &compare_command_move_archetypes>(moves.data, moves.size);
+        apply_moves(moves.data, moves.size);
+
+        moves.destroy();
     }
 
     template<typename ... Types>
@@ -76,8 +161,16 @@ namespace archecs{
         static_assert(index < 1u + sizeof...(Types));
 
         Entity* entity = entity_map.search(entity_handle);
-        if(entity)  *entity = archecs::attach_type(ecs_manager, type_metadata, *entity, index);
-        else        LOG_WARNING("attach_type (type_ID: %d) on unknown entity", index);
+        if(entity && entity->archetype_index == pending_archetype_index){
+            LOG_WARNING("attach_type (type_ID: %d) on pending entity ; use defer_attach_data", index);
+        }else if(entity){
+            Entity previous_entity = *entity;
+            u32 moved_index;
+            *entity = archecs::attach_type(ecs_manager, type_metadata, previous_entity, index, moved_index);
+            update_moved_entity(previous_entity, moved_index);
+        }else{
+            LOG_WARNING("attach_type (type_ID: %d) on unknown entity", index);
+        }
     }
 
     template<typename ... Types>
@@ -87,8 +180,16 @@ namespace archecs{
         static_assert(index < 1u + sizeof...(Types));
 
         Entity* entity = entity_map.search(entity_handle);
-        if(entity)  *entity = archecs::detach_type(ecs_manager, type_metadata, *entity, index);
-        else        LOG_WARNING("detach_type (type_ID: %d) on unknown entity", index);
+        if(entity && entity->archetype_index == pending_archetype_index){
+            LOG_WARNING("detach_type (type_ID: %d) on pending entity ; use defer_detach_data", index);
+        }else if(entity){
+            Entity previous_entity = *entity;
+            u32 moved_index;
+            *entity = archecs::detach_type(ecs_manager, type_metadata, previous_entity, index, moved_index);
+            update_moved_entity(previous_entity, moved_index);
+        }else{
+            LOG_WARNING("detach_type (type_ID: %d) on unknown entity", index);
+        }
     }
 
     template<typename ... Types>
@@ -98,7 +199,9 @@ namespace archecs{
         static_assert(index < 1u + sizeof...(Types));
 
         Entity* entity = entity_map.search(entity_handle);
-        if(entity){
+        if(entity && entity->archetype_index == pending_archetype_index){
+            return nullptr;
+        }else if(entity){
             return (T*)type_memory(ecs_manager, type_metadata, *entity, index);
         }else{
             LOG_WARNING("get_type (type_ID: %d) on unknown entity", index);
@@ -106,6 +209,15 @@ namespace archecs{
         }
     }
 
+    template<typename ... Types>
+    template<typename T>
+    T* Entity_Manager<Types...>::range_data(const Entity_Range& range){
+        constexpr u32 index = type_index<T, Entity_Handle, Types...>();
+        static_assert(index < 1u + sizeof...(Types));
+
+        return (T*)range_memory(ecs_manager, type_metadata, range, index);
+    }
+
     template<typename ... Types>
     bool Entity_Manager<Types...>::available_entity(const Entity_Handle entity_handle){
         return entity_map.search(entity_handle);
@@ -118,27 +230,300 @@ namespace archecs{
         static_assert(index < 1u + sizeof...(Types));
 
         Entity* entity = entity_map.search(entity_handle);
-        if(entity)  return search_type(ecs_manager.archetypes[entity->archetype_index], index) != -1;
-        else        return false;
+        if(entity && entity->archetype_index != pending_archetype_index)    return type_mask_test(ecs_manager.archetypes[entity->archetype_index].mask, index);
+        else                                                                return false;
+    }
+
+    template<typename ... Types>
+    void Entity_Manager<Types...>::update_moved_entity(const Entity entity, u32 moved_index){
+        if(moved_index != entity.index){
+            Entity_Handle* moved_entity_handle = (Entity_Handle*)type_memory(ecs_manager, type_metadata, entity, type_index_Entity_Handle);
+            assert(moved_entity_handle);
+
+            Entity* moved_entity = entity_map.search(*moved_entity_handle);
+            assert(moved_entity);
+
+            moved_entity->index = entity.index;
+        }
     }
 
     template<typename ... Types>
     template<typename ... System_Types>
     System Entity_Manager<Types...>::create_system(){
         System system;
+        static_assert(sizeof...(System_Types) <= max_ntypes);
         system.ntypes = sizeof...(System_Types);
 
-        // NOTE(hugo): extract type ID
-        constexpr u16 temp[] = { ((u16)type_index<System_Types, Entity_Handle, Types...>()) ... };
+        // NOTE(hugo): extract type ID and access
+        constexpr u16 temp[] = { ((u16)type_index<typename system_access<System_Types>::type, Entity_Handle, Types...>()) ... };
+        constexpr bool temp_write[] = { system_access<System_Types>::write ... };
         memcpy(system.type_IDs, temp, sizeof(temp));
 
         isort(system.type_IDs, system.ntypes);
+        system.mask = type_mask(system.type_IDs, system.ntypes);
+
+        // NOTE(hugo): the write mask follows the sorted type_IDs
+        system.write_mask = 0u;
+        for(u32 isys = 0u; isys != system.ntypes; ++isys){
+            for(u32 itemp = 0u; itemp != system.ntypes; ++itemp){
+                if(temp[itemp] == system.type_IDs[isys] && temp_write[itemp]) system.write_mask |= (1u << isys);
+            }
+        }
+
+        system.changed_mask = 0u;
+        system.changed_since = 0u;
+
+        system.query = nullptr;
+        system.parallel = false;
 
         return system;
     }
 
+    template<typename ... Types>
+    template<typename ... Filter_Types>
+    void Entity_Manager<Types...>::filter_changed(System& system, u32 version){
+        constexpr u16 temp[] = { ((u16)type_index<Filter_Types, Entity_Handle, Types...>()) ... };
+
+        system.changed_mask = 0u;
+        for(u32 ifilter = 0u; ifilter != sizeof...(Filter_Types); ++ifilter){
+            assert(type_mask_test(system.mask, temp[ifilter]));
+            system.changed_mask |= (1u << type_mask_rank(system.mask, temp[ifilter]));
+        }
+        system.changed_since = version;
+    }
+
+    template<typename ... Types>
+    u32 Entity_Manager<Types...>::current_version(){
+        return ecs_manager.version;
+    }
+
+    template<typename ... Types>
+    void Entity_Manager<Types...>::create_query(System& system){
+        assert(!system.query);
+        system.query = archecs::create_query(ecs_manager, system);
+    }
+
+    template<typename ... Types>
+    void Entity_Manager<Types...>::destroy_query(System& system){
+        assert(system.query);
+        archecs::destroy_query(ecs_manager, system.query);
+        system.query = nullptr;
+    }
+
     template<typename ... Types>
     void Entity_Manager<Types...>::execute_system(const System& system){
-        archecs::execute_system(ecs_manager, system);
+        archecs::execute_system(ecs_manager, system, worker_pool);
+    }
+
+    template<typename ... Types>
+    void Entity_Manager<Types...>::execute_scheduler(Scheduler& scheduler){
+        scheduler.execute(ecs_manager, worker_pool);
+    }
+
+    template<typename ... Types>
+    size_t Entity_Manager<Types...>::compact(u32 nkeep_free_chunks, size_t max_bytesize, u64 max_ticks){
+        return compact_manager(ecs_manager, nkeep_free_chunks, max_bytesize, max_ticks);
+    }
+
+    template<typename ... Types>
+    bool Entity_Manager<Types...>::save_snapshot(const File_Path& path){
+        assert(!commands.size);
+        return archecs::save_snapshot(ecs_manager, type_metadata, 1u + sizeof...(Types), entity_map, path);
+    }
+
+    template<typename ... Types>
+    bool Entity_Manager<Types...>::load_snapshot(const File_Path& path){
+        assert(!commands.size);
+        return archecs::load_snapshot(ecs_manager, type_metadata, 1u + sizeof...(Types), entity_map, path);
+    }
+    template<typename ... Types>
+    Entity_Handle Entity_Manager<Types...>::defer_create_entity(const Archetype& archetype){
+        indexmap_handle handle = entity_map.borrow_handle();
+
+        Entity* entity = entity_map.search(handle);
+        entity->archetype_index = pending_archetype_index;
+        entity->index = 0u;
+
+        Command command;
+        command.type = Command_Type::CREATE_ENTITY;
+        command.handle = (Entity_Handle){handle};
+        command.data = command_archetypes.size;
+        commands.push(command);
+
+        command_archetypes.push(archetype);
+
+        return (Entity_Handle){handle};
+    }
+
+    template<typename ... Types>
+    void Entity_Manager<Types...>::defer_destroy_entity(const Entity_Handle entity_handle){
+        Command command;
+        command.type = Command_Type::DESTROY_ENTITY;
+        command.handle = entity_handle;
+        command.data = 0u;
+        commands.push(command);
+    }
+
+    template<typename ... Types>
+    template<typename T>
+    void Entity_Manager<Types...>::defer_attach_data(const Entity_Handle entity_handle){
+        constexpr u32 index = type_index<T, Entity_Handle, Types...>();
+        static_assert(index < 1u + sizeof...(Types));
+
+        Command command;
+        command.type = Command_Type::ATTACH_TYPE;
+        command.handle = entity_handle;
+        command.data = index;
+        commands.push(command);
+    }
+
+    template<typename ... Types>
+    template<typename T>
+    void Entity_Manager<Types...>::defer_detach_data(const Entity_Handle entity_handle){
+        constexpr u32 index = type_index<T, Entity_Handle, Types...>();
+        static_assert(index < 1u + sizeof...(Types));
+
+        Command command;
+        command.type = Command_Type::DETACH_TYPE;
+        command.handle = entity_handle;
+        command.data = index;
+        commands.push(command);
+    }
+
+    template<typename ... Types>
+    void Entity_Manager<Types...>::apply_commands(){
+        if(!commands.size) return;
+
+        array<Command_Move> moves;
+        moves.create();
+        hashmap<u64, u32> handle_to_move;
+        handle_to_move.create();
+
+        // NOTE(hugo): resolve the destination archetype of every entity ; a handle appears once in /moves/
+        for(auto& command : commands){
+            u64 handle_key = ((u64)command.handle.generation << 32u) | (u64)command.handle.virtual_index;
+
+            u32* imove;
+            if(handle_to_move.get(handle_key, imove)){
+                Entity* entity = entity_map.search(command.handle);
+                if(!entity){
+                    LOG_WARNING("deferred command on unknown entity");
+                    handle_to_move.remove(handle_key);
+                    continue;
+                }
+
+                *imove = moves.size;
+
+                Command_Move move;
+                move.src_arch_index = entity->archetype_index;
+                move.dst_arch_index = entity->archetype_index;
+                move.src_index = entity->index;
+                move.handle = command.handle;
+                moves.push(move);
+            }
+
+            Command_Move& move = moves[*imove];
+
+            if(move.dst_arch_index == destroyed_archetype_index){
+                LOG_WARNING("deferred command on destroyed entity");
+                continue;
+            }
+
+            switch(command.type){
+                case Command_Type::CREATE_ENTITY:
+                    move.dst_arch_index = get_archetype(ecs_manager, command_archetypes[command.data]);
+                    break;
+                case Command_Type::DESTROY_ENTITY:
+                    move.dst_arch_index = destroyed_archetype_index;
+                    break;
+                case Command_Type::ATTACH_TYPE:
+                    move.dst_arch_index = get_archetype_with_type(ecs_manager, type_metadata, move.dst_arch_index, command.data);
+                    break;
+                case Command_Type::DETACH_TYPE:
+                    move.dst_arch_index = get_archetype_without_type(ecs_manager, type_metadata, move.dst_arch_index, command.data);
+                    break;
+            }
+        }
+
+        handle_to_move.destroy();
+        commands.clear();
+        command_archetypes.clear();
+
+        introsort<Command_Move, &compare_command_move_archetypes>(moves.data, moves.size);
+        apply_moves(moves.data, moves.size);
+
+        moves.destroy();
+    }
+
+    template<typename ... Types>
+    void Entity_Manager<Types...>::apply_moves(Command_Move* moves, u32 nmoves){
+        array<u32> src_indices;
+        src_indices.create();
+
+        u32 igroup = 0u;
+        while(igroup != nmoves){
+            u32 src_arch_index = moves[igroup].src_arch_index;
+            u32 dst_arch_index = moves[igroup].dst_arch_index;
+
+            u32 group_end = igroup + 1u;
+            while(group_end != nmoves
+            && moves[group_end].src_arch_index == src_arch_index
+            && moves[group_end].dst_arch_index == dst_arch_index){
+                ++group_end;
+            }
+            u32 count = group_end - igroup;
+            Command_Move* group = moves + igroup;
+            igroup = group_end;
+
+            if(src_arch_index == dst_arch_index) continue;
+
+            // NOTE(hugo): the source indices may have changed while applying the previous groups
+            if(src_arch_index != pending_archetype_index){
+                for(u32 imove = 0u; imove != count; ++imove){
+                    group[imove].src_index = entity_map.search(group[imove].handle)->index;
+                }
+                introsort<Command_Move, &compare_command_move_indices>(group, count);
+
+                src_indices.clear();
+                for(u32 imove = 0u; imove != count; ++imove) src_indices.push(group[imove].src_index);
+            }
+
+            if(dst_arch_index != destroyed_archetype_index){
+                u32 dst_first = allocate_entities_storage(ecs_manager, ecs_manager.archetypes[dst_arch_index], ecs_manager.storage[dst_arch_index], count);
+
+                if(src_arch_index != pending_archetype_index){
+                    copy_entities(ecs_manager, type_metadata, src_arch_index, src_indices.data, count, dst_arch_index, dst_first);
+                }
+
+                for(u32 imove = 0u; imove != count; ++imove){
+                    Entity new_entity;
+                    new_entity.archetype_index = dst_arch_index;
+                    new_entity.index = dst_first + imove;
+
+                    *entity_map.search(group[imove].handle) = new_entity;
+
+                    Entity_Handle* storage_handle = (Entity_Handle*)type_memory(ecs_manager, type_metadata, new_entity, type_index_Entity_Handle);
+                    *storage_handle = group[imove].handle;
+                }
+            }
+
+            // NOTE(hugo): decreasing order so that the entities moved into the vacated slots are never part of the group
+            if(src_arch_index != pending_archetype_index){
+                for(u32 imove = count; imove != 0u; --imove){
+                    Entity src_entity;
+                    src_entity.archetype_index = src_arch_index;
+                    src_entity.index = src_indices[imove - 1u];
+
+                    u32 moved_index = deallocate_entity(ecs_manager, type_metadata, src_entity);
+                    update_moved_entity(src_entity, moved_index);
+                }
+            }
+
+            if(dst_arch_index == destroyed_archetype_index){
+                for(u32 imove = 0u; imove != count; ++imove) entity_map.return_handle(group[imove].handle);
+            }
+        }
+
+        src_indices.destroy();
     }
 }
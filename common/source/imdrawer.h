@@ -67,7 +67,8 @@ struct ImDrawer{
 
     // ---- data
 
-    array<Command> commands;
+    // NOTE(hugo): varray ie pushing commands never copies the commands of the frame
+    varray<Command> commands;
     array<Buffer> buffers;
     array<Indexed_Buffer> indexed_buffers;
 };
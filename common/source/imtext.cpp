@@ -5,7 +5,9 @@ void Font_Stash::create(){
     packer.create();
     packer.set_packing_area(font_stash_default_dimension, font_stash_default_dimension);
 
-    image = bw_calloc(font_stash_default_dimension * font_stash_default_dimension, sizeof(u8));
+    image_arena.create(font_stash_max_dimension * font_stash_max_dimension);
+    image = image_arena.allocate(font_stash_default_dimension * font_stash_default_dimension, alignof(u8)).ptr;
+    memset(image, 0x00, font_stash_default_dimension * font_stash_default_dimension);
     dimension = font_stash_default_dimension;
 
     texture = Render_Layer_Invalid_Texture;
@@ -17,32 +19,36 @@ void Font_Stash::destroy(){
 
     packer.destroy();
 
-    bw_free(image);
+    image_arena.destroy();
 
     get_engine().render_layer.free_texture(texture);
 }
 
-static void increase_stash_area(Font_Stash* stash){
+// NOTE(hugo): returns false when the stash is already at font_stash_max_dimension
+static bool increase_stash_area(Font_Stash* stash){
     u32 new_dim = stash->dimension * 2u;
+    if(new_dim > font_stash_max_dimension){
+        LOG_WARNING("Font_Stash Error: stash is full at %ux%u", stash->dimension, stash->dimension);
+        return false;
+    }
 
     // NOTE(hugo): increase packing area
     stash->packer.set_packing_area(new_dim, new_dim);
 
-    // NOTE(hugo): reallocate and memcpy with new stride
-    void* new_stash = bw_calloc(new_dim * new_dim, sizeof(u8));
-
-    for(u32 iy = 0u; iy != stash->dimension; ++iy){
-        size_t src_offset = (stash->dimension - iy - 1u) * stash->dimension;
-        size_t dst_offset = (stash->dimension - iy - 1u) * new_dim;
+    // NOTE(hugo): extend the image in place and move the rows to the new stride
+    // from the last row to the first so that a row is never overwritten before being moved
+    stash->image_arena.allocate(new_dim * new_dim - stash->dimension * stash->dimension, alignof(u8));
 
-        u8* src_ptr = (u8*)stash->image + src_offset;
-        u8* dst_ptr = (u8*)new_stash    + dst_offset;
+    u8* image = (u8*)stash->image;
+    for(u32 iy = stash->dimension; iy != 0u; --iy){
+        size_t src_offset = (iy - 1u) * stash->dimension;
+        size_t dst_offset = (iy - 1u) * new_dim;
 
-        memcpy(dst_ptr, src_ptr, stash->dimension);
+        memmove(image + dst_offset, image + src_offset, stash->dimension);
+        memset(image + dst_offset + stash->dimension, 0x00, new_dim - stash->dimension);
     }
+    memset(image + stash->dimension * new_dim, 0x00, (new_dim - stash->dimension) * new_dim);
 
-    bw_free(stash->image);
-    stash->image = new_stash;
     stash->dimension = new_dim;
 
     for(auto& code_point : stash->font_data.cache){
@@ -51,6 +57,8 @@ static void increase_stash_area(Font_Stash* stash){
     }
 
     stash->texture_dirty = true;
+
+    return true;
 }
 
 static void prepare_stash_texture(Font_Stash* stash){
@@ -99,7 +107,11 @@ void Font_Stash::stash_code_point(s32 code_point, u32 font_size){
         if(bmp_width != 0u && bmp_height != 0u){
             uivec2 origin = packer.insert_rect(bmp_width + font_stash_padding, bmp_height + font_stash_padding);
             while(origin.x == UINT32_MAX){
-                increase_stash_area(this);
+                // NOTE(hugo): the code point is skipped when the stash cannot grow
+                if(!increase_stash_area(this)){
+                    font_data.cache.remove(key);
+                    return;
+                }
                 origin = packer.insert_rect(bmp_width + font_stash_padding, bmp_height + font_stash_padding);
             }
 
@@ -172,7 +184,7 @@ void draw_text(Font_Stash* stash, const char* str, ivec2 baseline, u32 font_size
         key.font_size = font_size;
 
         // NOTE(hugo): a code point may not be in the cache after stash_code_point
-        // if the code point cannot be rasterized (empty or undefined)
+        // if the code point cannot be rasterized (empty or undefined) or the stash is full
         Font_Stash::Font_Data::Code_Point_Data* data;
         if(stash->font_data.cache.search(key, data)){
             // NOTE(hugo): bounding box of the codepoint wrt. (current_x, baseline_y)
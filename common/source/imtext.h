@@ -80,6 +80,8 @@ Layout_Rect map_to_target(const Layout_Rect& rect, u32 in_width, u32 in_height,
 // https://github.com/memononen/fontstash
 
 constexpr u32 font_stash_default_dimension = 128u;
+// NOTE(hugo): the image is reserved for the maximum dimension and grows in place
+constexpr u32 font_stash_max_dimension = 8192u;
 constexpr u32 font_stash_padding = 2u;
 
 struct Font_Stash{
@@ -107,6 +109,7 @@ struct Font_Stash{
 
     Rect_Packer packer;
 
+    Virtual_Arena image_arena;
     void* image;
     u32 dimension;
 
@@ -26,6 +26,31 @@ void qsort(T* data, u32 size);
 template<typename T, s32 (*compare)(const T& A, const T& B) = &comparison_increasing_order>
 void isort(T* data, u32 size);
 
+// REF(hugo): http://www.cs.rpi.edu/~musser/gp/introsort.ps
+// NOTE(hugo): introspective sort ie same contract as qsort with /compare/ inlined
+// - quicksort with a median of three pivot
+// - heapsort when the recursion gets deeper than 2 log2(size) ie O(n log n) worst case
+// - insertion sort for partitions below 16 elements
+// - not stable
+// - only the sign of compare(L, R) > 0 is used ie compare can return (L > R) instead of a three way comparison
+template<typename T, s32 (*compare)(const T& A, const T& B) = &comparison_increasing_order>
+void introsort(T* data, u32 size);
+
+// REF(hugo): http://stereopsis.com/radix.html
+// NOTE(hugo): LSD radix sort with 8 bits digits in increasing order of /key/
+// - keys are u32, s32, float, u64, s64 or double
+// - one pass per byte of the key ; passes where every key has the same digit are skipped
+// - the temporary buffer is allocated from the scratch arena
+// - stable
+// ex : sorting particles by depth is radix_sort<Particle, float, &particle_depth>(particles, nparticles)
+namespace BEEWAX_INTERNAL{
+    template<typename T>
+    inline T radix_sort_identity(const T& element);
+}
+
+template<typename T, typename K = T, K (*key)(const T& element) = &BEEWAX_INTERNAL::radix_sort_identity<T>>
+void radix_sort(T* data, u32 size);
+
 // NOTE(hugo): returns nullptr when /value/ is not found
 template<typename T>
 T* binsearch_lower(T* data, u32 size, const T& value);
@@ -31,6 +31,217 @@ void isort(T* data, u32 size){
     }
 }
 
+namespace BEEWAX_INTERNAL{
+    constexpr u32 introsort_insertion_threshold = 16u;
+
+    // NOTE(hugo): insertion sort that moves the elements instead of swapping them
+    template<typename T, s32 (*compare)(const T& A, const T& B)>
+    inline void introsort_insertion(T* data, u32 size){
+        for(u32 icurrent = 1u; icurrent < size; ++icurrent){
+            T value = data[icurrent];
+            u32 position = icurrent;
+            while(position != 0u && compare(data[position - 1u], value) > 0){
+                data[position] = data[position - 1u];
+                --position;
+            }
+            data[position] = value;
+        }
+    }
+
+    // NOTE(hugo): same without the bound check ie an element that does not go after /value/ must precede data[icurrent] for every icurrent
+    template<typename T, s32 (*compare)(const T& A, const T& B)>
+    inline void introsort_insertion_unguarded(T* data, u32 begin, u32 size){
+        for(u32 icurrent = begin; icurrent < size; ++icurrent){
+            T value = data[icurrent];
+            u32 position = icurrent;
+            while(compare(data[position - 1u], value) > 0){
+                data[position] = data[position - 1u];
+                --position;
+            }
+            data[position] = value;
+        }
+    }
+
+    // NOTE(hugo): the heap root is the element that goes last
+    template<typename T, s32 (*compare)(const T& A, const T& B)>
+    inline void introsort_sift_down(T* data, u32 root, u32 size){
+        T value = data[root];
+        u32 child = 2u * root + 1u;
+        while(child < size){
+            if(child + 1u < size && compare(data[child + 1u], data[child]) > 0) ++child;
+            if(compare(data[child], value) <= 0) break;
+
+            data[root] = data[child];
+            root = child;
+            child = 2u * root + 1u;
+        }
+        data[root] = value;
+    }
+
+    template<typename T, s32 (*compare)(const T& A, const T& B)>
+    void introsort_heapsort(T* data, u32 size){
+        for(u32 iroot = size / 2u; iroot-- != 0u;){
+            introsort_sift_down<T, compare>(data, iroot, size);
+        }
+        for(u32 iend = size - 1u; iend != 0u; --iend){
+            swap(data[0u], data[iend]);
+            introsort_sift_down<T, compare>(data, 0u, iend);
+        }
+    }
+
+    // NOTE(hugo): returns the start of the upper partition ie compare(data[i], data[j]) <= 0 for i < cut <= j
+    // the median of data[0], data[size / 2] and data[size - 1] is moved to data[0] and used as the pivot
+    // the other two elements bound both scans ie no bound checks and 0 < cut < size
+    template<typename T, s32 (*compare)(const T& A, const T& B)>
+    inline u32 introsort_partition(T* data, u32 size){
+        u32 middle = size / 2u;
+        u32 last = size - 1u;
+
+        if(compare(data[0u], data[middle]) > 0) swap(data[0u], data[middle]);
+        if(compare(data[middle], data[last]) > 0){
+            swap(data[middle], data[last]);
+            if(compare(data[0u], data[middle]) > 0) swap(data[0u], data[middle]);
+        }
+        swap(data[0u], data[middle]);
+
+        const T pivot = data[0u];
+        u32 left = 1u;
+        u32 right = size;
+        while(true){
+            while(compare(pivot, data[left]) > 0) ++left;
+            --right;
+            while(compare(data[right], pivot) > 0) --right;
+            if(left >= right) return left;
+
+            swap(data[left], data[right]);
+            ++left;
+        }
+    }
+
+    // NOTE(hugo): recurses on the smaller partition ie the stack depth is at most log2(size)
+    // partitions below introsort_insertion_threshold are left unsorted for the final insertion sort
+    template<typename T, s32 (*compare)(const T& A, const T& B)>
+    void introsort_loop(T* data, u32 size, u32 depth_limit){
+        while(size > introsort_insertion_threshold){
+            if(depth_limit == 0u){
+                introsort_heapsort<T, compare>(data, size);
+                return;
+            }
+            --depth_limit;
+
+            u32 cut = introsort_partition<T, compare>(data, size);
+            if(cut < size - cut){
+                introsort_loop<T, compare>(data, cut, depth_limit);
+                data += cut;
+                size -= cut;
+            }else{
+                introsort_loop<T, compare>(data + cut, size - cut, depth_limit);
+                size = cut;
+            }
+        }
+    }
+}
+
+// NOTE(hugo): every element is at most introsort_insertion_threshold positions away from its sorted position after introsort_loop
+// ie the minimum is in the first partition and bounds the unguarded insertion sort of the remaining elements
+template<typename T, s32 (*compare)(const T& A, const T& B)>
+void introsort(T* data, u32 size){
+    using namespace BEEWAX_INTERNAL;
+    if(size < 2u) return;
+
+    u32 log2_size = 31u - bitscan_ML(size);
+    introsort_loop<T, compare>(data, size, 2u * log2_size);
+
+    if(size > introsort_insertion_threshold){
+        introsort_insertion<T, compare>(data, introsort_insertion_threshold);
+        introsort_insertion_unguarded<T, compare>(data, introsort_insertion_threshold, size);
+    }else{
+        introsort_insertion<T, compare>(data, size);
+    }
+}
+
+namespace BEEWAX_INTERNAL{
+    template<typename T>
+    inline T radix_sort_identity(const T& element){
+        return element;
+    }
+
+    // NOTE(hugo): unsigned integer with the same order as the key
+    // - signed integers : the sign bit is flipped
+    // - floats : the sign bit is flipped for positive floats and every bit is flipped for negative floats
+    inline u32 radix_sort_bits(u32 key){
+        return key;
+    }
+    inline u32 radix_sort_bits(s32 key){
+        return (u32)key ^ 0x80000000u;
+    }
+    inline u32 radix_sort_bits(float key){
+        u32 bits;
+        memcpy(&bits, &key, sizeof(u32));
+        return bits ^ ((u32)((s32)bits >> 31u) | 0x80000000u);
+    }
+    inline u64 radix_sort_bits(u64 key){
+        return key;
+    }
+    inline u64 radix_sort_bits(s64 key){
+        return (u64)key ^ 0x8000000000000000u;
+    }
+    inline u64 radix_sort_bits(double key){
+        u64 bits;
+        memcpy(&bits, &key, sizeof(u64));
+        return bits ^ ((u64)((s64)bits >> 63u) | 0x8000000000000000u);
+    }
+}
+
+template<typename T, typename K, K (*key)(const T& element)>
+void radix_sort(T* data, u32 size){
+    using namespace BEEWAX_INTERNAL;
+    using Bits = decltype(radix_sort_bits(K()));
+    constexpr u32 ndigits = sizeof(Bits);
+
+    if(size < 2u) return;
+
+    Scratch_Scope scratch;
+    T* buffer = scratch.allocate<T>(size);
+    u32* histograms = scratch.allocate<u32>(ndigits * 256u);
+    memset(histograms, 0, sizeof(u32) * ndigits * 256u);
+
+    // NOTE(hugo): the histograms of every digit in a single pass
+    for(u32 ielement = 0u; ielement != size; ++ielement){
+        Bits bits = radix_sort_bits(key(data[ielement]));
+        for(u32 idigit = 0u; idigit != ndigits; ++idigit){
+            ++histograms[idigit * 256u + (u32)((bits >> (idigit * 8u)) & 0xFFu)];
+        }
+    }
+
+    T* source = data;
+    T* destination = buffer;
+    for(u32 idigit = 0u; idigit != ndigits; ++idigit){
+        u32* histogram = histograms + idigit * 256u;
+        u32 shift = idigit * 8u;
+
+        u32 first_digit = (u32)((radix_sort_bits(key(source[0u])) >> shift) & 0xFFu);
+        if(histogram[first_digit] == size) continue;
+
+        // NOTE(hugo): exclusive prefix sum ie position of the first element of each digit
+        u32 offset = 0u;
+        for(u32 idigit_value = 0u; idigit_value != 256u; ++idigit_value){
+            u32 count = histogram[idigit_value];
+            histogram[idigit_value] = offset;
+            offset += count;
+        }
+
+        for(u32 ielement = 0u; ielement != size; ++ielement){
+            u32 digit = (u32)((radix_sort_bits(key(source[ielement])) >> shift) & 0xFFu);
+            destination[histogram[digit]++] = source[ielement];
+        }
+
+        swap(source, destination);
+    }
+
+    if(source != data) memcpy(data, source, sizeof(T) * size);
+}
+
 namespace BEEWAX_INTERNAL{
     // NOTE(hugo): returns the insertion poinclosest element that is < /value/
     // ie may return (data + size) that is outside of data when there is no element >= /value/ in /data/
@@ -17,18 +17,18 @@ void Asset_Loader::create_from_json(const File_Path& json_path){
         cJSON* json_type = cJSON_GetObjectItemCaseSensitive(json_asset, "type");
         ENGINE_CHECK(json_type && cJSON_IsString(json_type), "Asset_Loader::create_from_json Error: expecting a 'type' string for asset %d", iasset);
 
-        Asset_Type type;
-        type = json_type->valuestring;
+        // NOTE(hugo): the libraries interned their type on creation
+        String_ID type = search_string_id(json_type->valuestring);
 
         u32 ilib;
         for(ilib = 0u; ilib != nlibraries; ++ilib){
-            if(libraries[ilib]->type == json_type->valuestring){
+            if(libraries[ilib]->type == type){
                 libraries[ilib]->func_create_asset(libraries[ilib], json_asset);
                 break;
             }
         }
 
-        if(ilib == nlibraries) LOG_WARNING("Asset_Loader::create_from_json Error: unknown asset type: %s for asset %d", type.data, iasset);
+        if(ilib == nlibraries) LOG_WARNING("Asset_Loader::create_from_json Error: unknown asset type: %s for asset %d", json_type->valuestring, iasset);
     }
 
     cJSON_Delete(json_tree);
@@ -36,12 +36,12 @@ void Asset_Loader::create_from_json(const File_Path& json_path){
 }
 
 void Audio_Library::create(){
-    type = "audio";
+    type = STRING_ID("audio");
     func_create_asset = [](Asset_Library* this_ptr, cJSON* json){
         Audio_Library* tptr = (Audio_Library*)this_ptr;
         (*tptr).asset_create_from_json(json);
     };
-    func_destroy_asset = [](Asset_Library* this_ptr, Asset_Name name){
+    func_destroy_asset = [](Asset_Library* this_ptr, String_ID name){
         Audio_Library* tptr = (Audio_Library*)this_ptr;
         (*tptr).asset_destroy(name);
     };
@@ -58,10 +58,9 @@ void Audio_Library::destroy(){
 
 void Audio_Library::asset_create_from_json(cJSON* json){
     cJSON* json_name = cJSON_GetObjectItemCaseSensitive(json, "name");
-    assert(json_name && cJSON_IsString(json_name) && strlen(json_name->valuestring) <= Asset_Name::strcap());
+    assert(json_name && cJSON_IsString(json_name));
 
-    Asset_Name name;
-    name = json_name->valuestring;
+    String_ID name = string_id(json_name->valuestring);
 
     Audio_Asset** asset;
     if(map.get(name, asset)){
@@ -80,22 +79,22 @@ void Audio_Library::asset_create_from_json(cJSON* json){
         make_audio_asset_from_wav_file(*asset, path, audio);
 
     }else{
-        LOG_WARNING("asset name: %s was already in Audio_Library", name.data);
+        LOG_WARNING("asset name: %s was already in Audio_Library", json_name->valuestring);
 
     }
 }
 
-void Audio_Library::asset_destroy(Asset_Name name){
+void Audio_Library::asset_destroy(String_ID name){
     auto remove_procedure = [](Audio_Asset*& asset){
         free_audio_asset(asset);
         bw_free(asset);
     };
     if(!map.remove_func(name, remove_procedure)){
-        LOG_WARNING("asset name: %s was not in Audio_Library", name.data);
+        LOG_WARNING("asset name: %s was not in Audio_Library", string_id_cstring(name));
     }
 }
 
-Audio_Asset* Audio_Library::search(Asset_Name name){
+Audio_Asset* Audio_Library::search(String_ID name){
     Audio_Asset** out_search;
     if(map.search(name, out_search)){
         return *out_search;
@@ -1,15 +1,15 @@
 #ifndef H_ASSET_MANAGEMENT
 #define H_ASSET_MANAGEMENT
 
-typedef sstring<32u> Asset_Type;
 typedef sstring<64u> Asset_Name;
 
 static const char* asset_folder_path = "./data";
 
+// NOTE(hugo): asset types and asset names are interned ie libraries are matched and searched with a String_ID
 struct Asset_Library{
-    Asset_Type type;
+    String_ID type;
     void (*func_create_asset)(Asset_Library* this_ptr, cJSON* json);
-    void (*func_destroy_asset)(Asset_Library* this_ptr, Asset_Name name);
+    void (*func_destroy_asset)(Asset_Library* this_ptr, String_ID name);
 };
 
 struct Asset_Loader{
@@ -33,14 +33,14 @@ struct Audio_Library : Asset_Library{
     // --
 
     void asset_create_from_json(cJSON* json);
-    void asset_destroy(Asset_Name name);
+    void asset_destroy(String_ID name);
 
-    Audio_Asset* search(Asset_Name name);
+    Audio_Asset* search(String_ID name);
 
     // ----
 
     Audio_Player* audio;
-    hashmap<Asset_Name, Audio_Asset*> map;
+    hashmap<String_ID, Audio_Asset*> map;
 };
 
 struct Texture_Library : Asset_Library{
@@ -50,14 +50,14 @@ struct Texture_Library : Asset_Library{
     // --
 
     void asset_create_from_json(cJSON* json);
-    void asset_destroy(Asset_Name name);
+    void asset_destroy(String_ID name);
 
-    Texture_Asset* search(Asset_Name name);
+    Texture_Asset* search(String_ID name);
 
     // ----
 
     Render_Layer* rlayer;
-    hashmap<Asset_Name, Texture_Asset*> map;
+    hashmap<String_ID, Texture_Asset*> map;
 };
 
 struct Texture_Animation_Library : Asset_Library{
@@ -67,14 +67,14 @@ struct Texture_Animation_Library : Asset_Library{
     // --
 
     void asset_create_from_json(cJSON* json);
-    void asset_destroy(Asset_Name name);
+    void asset_destroy(String_ID name);
 
-    Texture_Animation_Asset* search(Asset_Name name);
+    Texture_Animation_Asset* search(String_ID name);
 
     // ----
 
     Render_Layer* rlayer;
-    hashmap<Asset_Name, Texture_Animation_Asset*> map;
+    hashmap<String_ID, Texture_Animation_Asset*> map;
 };
 
 struct Font_Library : Asset_Library{
@@ -84,13 +84,13 @@ struct Font_Library : Asset_Library{
     // --
 
     void asset_create_from_json(cJSON* json);
-    void asset_destroy(Asset_Name name);
+    void asset_destroy(String_ID name);
 
-    Font_Asset* search(Asset_Name name);
+    Font_Asset* search(String_ID name);
 
     // ----
 
-    hashmap<Asset_Name, Font_Asset*> map;
+    hashmap<String_ID, Font_Asset*> map;
 };
 
 #endif
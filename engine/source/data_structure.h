@@ -9,11 +9,43 @@
 // https://ourmachinery.com/post/minimalist-container-library-in-c-part-2/
 // http://bitsquid.blogspot.com/2011/09/managing-decoupling-part-4-id-lookup.html
 
+// ---- allocator policy
+// NOTE(hugo): memory of array and hashmap ; the policy is copied into the container by create()
+// reallocate and free receive the previous bytesize such that arenas and pools need no header
+// /!\ the containers do not call destroy() on their elements /!\ containers using an arena can be dropped when the arena is reset
+
+constexpr size_t allocator_policy_alignment = 16u;
+
+// NOTE(hugo): bw_malloc, bw_realloc and bw_free ie the default
+struct Heap_Allocator{
+    void* allocate(size_t bytesize);
+    void* reallocate(void* ptr, size_t previous_bytesize, size_t bytesize);
+    void free(void* ptr, size_t bytesize);
+};
+
+// NOTE(hugo): free is a no-op ; the last allocation of the arena grows in place
+struct Arena_Allocator{
+    void* allocate(size_t bytesize);
+    void* reallocate(void* ptr, size_t previous_bytesize, size_t bytesize);
+    void free(void* ptr, size_t bytesize);
+
+    Virtual_Arena* arena;
+};
+
+// NOTE(hugo): the container is valid until the next new_frame() of the frame allocator ie cf. Frame_Allocator
+struct Frame_Arena_Allocator{
+    void* allocate(size_t bytesize);
+    void* reallocate(void* ptr, size_t previous_bytesize, size_t bytesize);
+    void free(void* ptr, size_t bytesize);
+
+    Frame_Allocator* frame_allocator;
+};
+
 // ---- array
 
-template<typename T>
+template<typename T, typename Allocator = Heap_Allocator>
 struct array{
-    void create();
+    void create(const Allocator& allocator = Allocator());
     void destroy();
 
     const T& operator[](size_t index) const;
@@ -45,10 +77,107 @@ struct array{
     T* data;
     size_t size;
     size_t capacity;
+
+    Allocator allocator;
 };
 
+template<typename T, typename Allocator>
+void copy(array<T, Allocator>* dest, array<T, Allocator>* src);
+
+// ---- varray
+// NOTE(hugo): array in a virtual memory range reserved by create() ie push never copies and the elements never move
+// pages are committed as the array grows ; /max_capacity/ is fixed at creation and exceeding it is an error
+
+constexpr size_t varray_max_bytesize = GIGABYTES(1u);
+// NOTE(hugo): minimum growth ie amortizes the commit syscalls of small elements
+constexpr size_t varray_min_grow_bytesize = KILOBYTES(64u);
+
 template<typename T>
-void copy(array<T>* dest, array<T>* src);
+struct varray{
+    void create(size_t max_capacity = varray_max_bytesize / sizeof(T));
+    void destroy();
+
+    const T& operator[](size_t index) const;
+    T& operator[](size_t index);
+
+    T& push(const T& v);
+    T pop();
+    void remove_swap(size_t index);
+
+    void resize(size_t new_size);
+    void reserve(size_t new_capacity);
+    void clear();
+
+    // NOTE(hugo): returns the pages after /size/ to the OS
+    void shrink();
+
+    // ---- iterator
+
+    typedef T* iterator;
+
+    iterator begin();
+    iterator end();
+    const T* begin() const;
+    const T* end() const;
+
+    // ---- data
+
+    T* data;
+    size_t size;
+    size_t capacity;
+
+    Virtual_Arena arena;
+};
+
+// ---- sbarray
+// NOTE(hugo): array with /N/ elements stored inline ie spills to the heap only past /N/ elements
+// data() instead of a data pointer such that the storage can be moved with the struct while inline
+// capacity == N when the elements are inline ; the heap memory is kept after clear()
+
+template<typename T, u32 N>
+struct sbarray{
+    static_assert(N != 0u);
+
+    void create();
+    void destroy();
+
+    T* data();
+    const T* data() const;
+    bool is_inline() const;
+
+    const T& operator[](size_t index) const;
+    T& operator[](size_t index);
+
+    T& push(const T& v);
+    T pop();
+    T& insert(size_t index, const T& v);
+    T* insert_multi(size_t index, size_t count);
+    void remove(size_t index);
+    void remove_multi(size_t index, size_t count);
+    void remove_swap(size_t index);
+
+    void resize(size_t new_size);
+    void reserve(size_t new_capacity);
+    void clear();
+
+    // ---- iterator
+
+    typedef T* iterator;
+
+    iterator begin();
+    iterator end();
+    const T* begin() const;
+    const T* end() const;
+
+    // ---- data
+
+    size_t size;
+    size_t capacity;
+    union{
+        alignas(T) u8 inline_storage[N * sizeof(T)];
+        T* heap_data;
+    };
+};
 
 // ---- hashmap
 // - user-provided identifiers
@@ -79,11 +208,13 @@ void copy(array<T>* dest, array<T>* src);
 //  key was not in hashmap
 
 // REF(hugo):
-// https://github.com/attractivechaos/klib/blob/master/khash.h
-// https://attractivechaos.wordpress.com/2018/01/13/revisiting-hash-table-performance/
+// https://abseil.io/about/design/swisstables
+// https://www.youtube.com/watch?v=ncHmEUmJZf4
 
 inline u32 hashmap_hash(const u32& key);
 inline u32 hashmap_hash(const s32& key);
+inline u32 hashmap_hash(const u64& key);
+// NOTE(hugo): strings and keys hashed as bytes use hash_wyhash ; sstring and File_Path only hash their used length
 inline u32 hashmap_hash(const char* str);
 inline u32 hashmap_hash(const char* str, size_t strlen);
 
@@ -92,25 +223,126 @@ u32 hashmap_hash(const kT*& key);
 template<typename kT>
 u32 hashmap_hash(const kT& key);
 
-#define kcalloc(count, bytesize)    bw_calloc(count, bytesize)
-#define kmalloc(bytesize)           bw_malloc(bytesize)
-#define krealloc(pointer, bytesize) bw_realloc(pointer, bytesize)
-#define kfree(ptr)                  bw_free(ptr)
+// NOTE(hugo): open addressing with one control byte per slot ie swiss table
+// - control byte = empty, deleted or the 7 low bits of the hash ; the key is only compared when the control byte matches
+// - slots are probed by groups of 16 control bytes compared at once with SSE2
+// - keys and values are stored together
+// - the maximum load factor is 7/8 ; reserve(n) fits n keys without rehashing
+// /!\ get() and reserve() can rehash ie invalidate the value pointers /!\ same as khashmap
+
+namespace BEEWAX_INTERNAL{
+    constexpr u32 hashmap_group_width = 16u;
+    constexpr u8 hashmap_ctrl_empty = 0x80u;
+    constexpr u8 hashmap_ctrl_deleted = 0xFEu;
+    // NOTE(hugo): number of keys prefetched ahead in search_many()
+    constexpr u32 hashmap_search_batch = 16u;
+}
+
+template<typename kT, typename vT, typename Allocator = Heap_Allocator>
+struct hashmap{
+    void create(const Allocator& allocator = Allocator());
+    void destroy();
+
+    size_t size() const;
+    size_t capacity() const;
+
+    u32 get(const kT& key, vT*& v);
+    u32 search(const kT& key, vT*& v) const;
+    // NOTE(hugo): same as search() for each key ; /v/[ikey] is nullptr when /keys/[ikey] is not in the hashmap
+    // the keys are hashed and their groups prefetched by batches ie the cache misses of the batch overlap
+    // returns the number of keys found
+    u32 search_many(const kT* keys, u32 nkeys, vT** v) const;
+    u32 remove(const kT& key);
+    u32 remove_func(const kT& key, void (*destroy_value)(vT& v));
+
+    void reserve(size_t new_capacity);
+    void clear();
+
+    // -- iterator
+
+    struct iterator;
+    struct iterator{
+        kT& key();
+        const kT& key() const;
+
+        vT& value();
+        const vT& value() const;
+
+        iterator& operator*();
+        const iterator& operator*() const;
+
+        iterator& operator++();
+        bool operator!=(const iterator& iter) const;
+
+        // ---- data
+
+        hashmap* map;
+        size_t index;
+    };
+
+    iterator begin();
+    iterator end();
+    const iterator begin() const;
+    const iterator end() const;
+
+    // ---- data
+
+    struct Slot{
+        kT key;
+        vT value;
+    };
+
+    // NOTE(hugo): single allocation ie ctrl[nslots] then slots[nslots]
+    u8* ctrl;
+    Slot* slots;
+    size_t nslots;
+    size_t nentries;
+    // NOTE(hugo): number of empty slots that can be filled before reaching the maximum load factor
+    size_t growth_left;
+
+    Allocator allocator;
+};
+
+// ---- khashmap
+// NOTE(hugo): khash wrapper with the same contract as hashmap ; kept as a reference for benchmarks
+// REF(hugo):
+// https://github.com/attractivechaos/klib/blob/master/khash.h
+// https://attractivechaos.wordpress.com/2018/01/13/revisiting-hash-table-performance/
+
+// NOTE(hugo): khash allocates through the allocator policy stored in the table ie /h/ in the khash functions
+// kh_init and kh_destroy are not used ie the table is embedded in the khashmap
+#define kcalloc(count, bytesize)    (nullptr)
+#define kmalloc(bytesize)           (h->allocator.allocate(bytesize))
+#define krealloc(pointer, bytesize) (khash_reallocate(h, pointer, bytesize))
+#define kfree(ptr)                  (khash_free(h, ptr))
 #include "khash.h"
 
-template<typename kT, typename vT>
-struct hashmap{
+template<typename kT, typename vT, typename Allocator = Heap_Allocator>
+struct khashmap{
     // ---- khash
 
+    // NOTE(hugo): __KHASH_TYPE with the allocator policy
+    typedef struct kh_kinstance_s{
+        khint_t n_buckets, size, n_occupied, upper_bound;
+        khint32_t* flags;
+        kT* keys;
+        vT* vals;
+        Allocator allocator;
+    } kh_kinstance_t;
+
     #define khash_hash_key(key)                 (hashmap_hash(key))
     #define khash_hash_compare(hashA, hashB)    ((hashA) == (hashB))
-    KHASH_INIT(kinstance, kT, vT, 1, khash_hash_key, khash_hash_compare)
+    __KHASH_IMPL(kinstance, static kh_inline klib_unused, kT, vT, 1, khash_hash_key, khash_hash_compare)
     #undef khash_hash_key
     #undef khash_hash_compare
 
+    // NOTE(hugo): the bytesize of keys, vals and flags is deduced from the number of buckets before the resize
+    static void* khash_reallocate(kh_kinstance_t* h, void* ptr, size_t bytesize);
+    static void khash_free(kh_kinstance_t* h, void* ptr);
+
     // ----
 
-    void create();
+    void create(const Allocator& allocator = Allocator());
     void destroy();
 
     size_t size();
@@ -158,6 +390,9 @@ struct hashmap{
 
 #include "data_structure.inl"
 
+#undef kcalloc
+#undef kmalloc
+#undef krealloc
 #undef kfree
 
 #endif
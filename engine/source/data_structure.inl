@@ -1,3 +1,52 @@
+// ---- allocator policy
+
+inline void* Heap_Allocator::allocate(size_t bytesize){
+    return bw_malloc(bytesize);
+}
+
+inline void* Heap_Allocator::reallocate(void* ptr, size_t, size_t bytesize){
+    return bw_realloc(ptr, bytesize);
+}
+
+inline void Heap_Allocator::free(void* ptr, size_t){
+    bw_free(ptr);
+}
+
+inline void* Arena_Allocator::allocate(size_t bytesize){
+    return arena->allocate(bytesize, allocator_policy_alignment).ptr;
+}
+
+inline void* Arena_Allocator::reallocate(void* ptr, size_t previous_bytesize, size_t bytesize){
+    if(!ptr) return allocate(bytesize);
+
+    // NOTE(hugo): last allocation of the arena
+    if((u8*)ptr + previous_bytesize == (u8*)arena->vmemory + arena->cursor){
+        if(bytesize > previous_bytesize)    arena->allocate(bytesize - previous_bytesize, 1u);
+        else                                arena->cursor -= previous_bytesize - bytesize;
+        return ptr;
+    }
+
+    void* new_ptr = allocate(bytesize);
+    memcpy(new_ptr, ptr, min(previous_bytesize, bytesize));
+    return new_ptr;
+}
+
+inline void Arena_Allocator::free(void*, size_t){
+}
+
+inline void* Frame_Arena_Allocator::allocate(size_t bytesize){
+    return frame_allocator->allocate(bytesize, allocator_policy_alignment);
+}
+
+inline void* Frame_Arena_Allocator::reallocate(void* ptr, size_t previous_bytesize, size_t bytesize){
+    void* new_ptr = allocate(bytesize);
+    if(ptr) memcpy(new_ptr, ptr, min(previous_bytesize, bytesize));
+    return new_ptr;
+}
+
+inline void Frame_Arena_Allocator::free(void*, size_t){
+}
+
 // ---- array
 
 namespace BEEWAX_INTERNAL{
@@ -16,69 +65,70 @@ namespace BEEWAX_INTERNAL{
         return max((size_t)16u, capacity);
     }
 
-    template<typename T>
-    void array_reallocate_to_capacity(array<T>& array, size_t new_capacity){
-        void* new_data = bw_realloc((void*)array.data, new_capacity * sizeof(T));
+    template<typename T, typename Allocator>
+    void array_reallocate_to_capacity(array<T, Allocator>& array, size_t new_capacity){
+        void* new_data = array.allocator.reallocate((void*)array.data, array.capacity * sizeof(T), new_capacity * sizeof(T));
         assert(new_data);
 
         array.data = (T*)new_data;
         array.capacity = new_capacity;
     }
 
-    template<typename T>
-    void array_increase_capacity(array<T>& array){
+    template<typename T, typename Allocator>
+    void array_increase_capacity(array<T, Allocator>& array){
         size_t new_capacity = BEEWAX_INTERNAL::array_next_capacity(array.capacity);
         array_reallocate_to_capacity(array, new_capacity);
     }
 
-    template<typename T>
-    void array_increase_capacity_min(array<T>& array, size_t min_capacity){
+    template<typename T, typename Allocator>
+    void array_increase_capacity_min(array<T, Allocator>& array, size_t min_capacity){
         size_t new_capacity = BEEWAX_INTERNAL::array_next_capacity(max(array.capacity, min_capacity));
         array_reallocate_to_capacity(array, new_capacity);
     }
 }
 
 
-template<typename T>
-void array<T>::create(){
+template<typename T, typename Allocator>
+void array<T, Allocator>::create(const Allocator& input_allocator){
+    allocator = input_allocator;
     data = nullptr;
     size = (size_t)0u;
     capacity = (size_t)0u;
 }
 
-template<typename T>
-void array<T>::destroy(){
-    bw_free(data);
+template<typename T, typename Allocator>
+void array<T, Allocator>::destroy(){
+    allocator.free((void*)data, capacity * sizeof(T));
 }
 
-template<typename T>
-const T& array<T>::operator[](size_t index) const{
+template<typename T, typename Allocator>
+const T& array<T, Allocator>::operator[](size_t index) const{
     assert(index < size);
     return data[index];
 }
 
-template<typename T>
-T& array<T>::operator[](size_t index){
+template<typename T, typename Allocator>
+T& array<T, Allocator>::operator[](size_t index){
     assert(index < size);
     return data[index];
 }
 
-template<typename T>
-T& array<T>::push(const T& v){
+template<typename T, typename Allocator>
+T& array<T, Allocator>::push(const T& v){
     if(size == capacity) BEEWAX_INTERNAL::array_increase_capacity(*this);
     data[size] = v;
     return data[size++];
 }
 
-template<typename T>
-T array<T>::pop(){
+template<typename T, typename Allocator>
+T array<T, Allocator>::pop(){
     assert(size);
     --size;
     return data[size];
 }
 
-template<typename T>
-T& array<T>::insert(size_t index, const T& v){
+template<typename T, typename Allocator>
+T& array<T, Allocator>::insert(size_t index, const T& v){
     assert(!(index > size));
 
     if(size == capacity) BEEWAX_INTERNAL::array_increase_capacity(*this);
@@ -88,8 +138,8 @@ T& array<T>::insert(size_t index, const T& v){
     return data[index];
 }
 
-template<typename T>
-T* array<T>::insert_multi(size_t index, size_t count){
+template<typename T, typename Allocator>
+T* array<T, Allocator>::insert_multi(size_t index, size_t count){
     assert(!(index > size));
 
     if(size + count > capacity) BEEWAX_INTERNAL::array_increase_capacity_min(*this, size + count);
@@ -98,70 +148,340 @@ T* array<T>::insert_multi(size_t index, size_t count){
     return data + index;
 }
 
-template<typename T>
-void array<T>::remove(size_t index){
+template<typename T, typename Allocator>
+void array<T, Allocator>::remove(size_t index){
     assert(index < size);
 
     if(index < size - 1u) memmove(data + index, data + index + 1u, (size - index - 1u) * sizeof(T));
     --size;
 }
 
-template<typename T>
-void array<T>::remove_multi(size_t index, size_t count){
+template<typename T, typename Allocator>
+void array<T, Allocator>::remove_multi(size_t index, size_t count){
     assert(index + count < size + 1u);
 
     if(index + count < size) memmove(data + index, data + index + count, (size - index - count) * sizeof(T));
     size -= count;
 }
 
+template<typename T, typename Allocator>
+void array<T, Allocator>::remove_swap(size_t index){
+    assert(index < size);
+    --size;
+    data[index] = data[size];
+}
+
+template<typename T, typename Allocator>
+void array<T, Allocator>::resize(size_t new_size){
+    if(new_size > capacity) BEEWAX_INTERNAL::array_increase_capacity_min(*this, new_size);
+    size = new_size;
+}
+
+template<typename T, typename Allocator>
+void array<T, Allocator>::reserve(size_t new_capacity){
+    if(new_capacity > capacity) BEEWAX_INTERNAL::array_increase_capacity_min(*this, new_capacity);
+}
+
+template<typename T, typename Allocator>
+void array<T, Allocator>::clear(){
+    size = 0u;
+}
+
+template<typename T, typename Allocator>
+typename array<T, Allocator>::iterator array<T, Allocator>::begin(){
+    return data;
+}
+
+template<typename T, typename Allocator>
+typename array<T, Allocator>::iterator array<T, Allocator>::end(){
+    return data + size;
+}
+
+template<typename T, typename Allocator>
+const typename array<T, Allocator>::iterator array<T, Allocator>::begin() const{
+    return data;
+}
+
+template<typename T, typename Allocator>
+const typename array<T, Allocator>::iterator array<T, Allocator>::end() const{
+    return data + size;
+}
+
+template<typename T, typename Allocator>
+void copy(array<T, Allocator>* dest, array<T, Allocator>* src){
+    assert(dest != src);
+    dest.reserve(src.size);
+    memcpy(dest.data, src.data, src.size * sizeof(T));
+}
+
+// ---- varray
+
+namespace BEEWAX_INTERNAL{
+    template<typename T>
+    void varray_commit_capacity(varray<T>& array, size_t min_capacity){
+        size_t max_capacity = array.arena.vbytesize / sizeof(T);
+        ENGINE_CHECK(min_capacity <= max_capacity, "varray OUT OF CAPACITY");
+
+        size_t new_capacity = max(min_capacity, array.capacity + max(array.capacity, varray_min_grow_bytesize / sizeof(T)));
+        new_capacity = min(new_capacity, max_capacity);
+
+        // NOTE(hugo): the arena cursor is the committed bytesize of the array
+        array.arena.allocate(new_capacity * sizeof(T) - array.arena.cursor, 1u);
+        array.capacity = new_capacity;
+    }
+}
+
+template<typename T>
+void varray<T>::create(size_t max_capacity){
+    arena.create(max_capacity * sizeof(T));
+    data = (T*)arena.vmemory;
+    size = (size_t)0u;
+    capacity = (size_t)0u;
+}
+
+template<typename T>
+void varray<T>::destroy(){
+    arena.destroy();
+}
+
+template<typename T>
+const T& varray<T>::operator[](size_t index) const{
+    assert(index < size);
+    return data[index];
+}
+
 template<typename T>
-void array<T>::remove_swap(size_t index){
+T& varray<T>::operator[](size_t index){
+    assert(index < size);
+    return data[index];
+}
+
+template<typename T>
+T& varray<T>::push(const T& v){
+    if(size == capacity) BEEWAX_INTERNAL::varray_commit_capacity(*this, size + 1u);
+    data[size] = v;
+    return data[size++];
+}
+
+template<typename T>
+T varray<T>::pop(){
+    assert(size);
+    --size;
+    return data[size];
+}
+
+template<typename T>
+void varray<T>::remove_swap(size_t index){
     assert(index < size);
     --size;
     data[index] = data[size];
 }
 
 template<typename T>
-void array<T>::resize(size_t new_size){
-    if(new_size > capacity) BEEWAX_INTERNAL::array_increase_capacity_min(*this, new_size);
+void varray<T>::resize(size_t new_size){
+    if(new_size > capacity) BEEWAX_INTERNAL::varray_commit_capacity(*this, new_size);
     size = new_size;
 }
 
 template<typename T>
-void array<T>::reserve(size_t new_capacity){
-    if(new_capacity > capacity) BEEWAX_INTERNAL::array_increase_capacity_min(*this, new_capacity);
+void varray<T>::reserve(size_t new_capacity){
+    if(new_capacity > capacity) BEEWAX_INTERNAL::varray_commit_capacity(*this, new_capacity);
 }
 
 template<typename T>
-void array<T>::clear(){
+void varray<T>::clear(){
     size = 0u;
 }
 
 template<typename T>
-typename array<T>::iterator array<T>::begin(){
+void varray<T>::shrink(){
+    arena.cursor = size * sizeof(T);
+    arena.reset_to_cursor();
+    capacity = size;
+}
+
+template<typename T>
+typename varray<T>::iterator varray<T>::begin(){
     return data;
 }
 
 template<typename T>
-typename array<T>::iterator array<T>::end(){
+typename varray<T>::iterator varray<T>::end(){
     return data + size;
 }
 
 template<typename T>
-const typename array<T>::iterator array<T>::begin() const{
+const T* varray<T>::begin() const{
     return data;
 }
 
 template<typename T>
-const typename array<T>::iterator array<T>::end() const{
+const T* varray<T>::end() const{
     return data + size;
 }
 
-template<typename T>
-void copy(array<T>* dest, array<T>* src){
-    assert(dest != src);
-    dest.reserve(src.size);
-    memcpy(dest.data, src.data, src.size * sizeof(T));
+// ---- sbarray
+
+namespace BEEWAX_INTERNAL{
+    template<typename T, u32 N>
+    void sbarray_reallocate_to_capacity(sbarray<T, N>& array, size_t new_capacity){
+        if(array.is_inline()){
+            T* new_data = (T*)bw_malloc(new_capacity * sizeof(T));
+            assert(new_data);
+            memcpy((void*)new_data, array.inline_storage, array.size * sizeof(T));
+            array.heap_data = new_data;
+
+        }else{
+            void* new_data = bw_realloc((void*)array.heap_data, new_capacity * sizeof(T));
+            assert(new_data);
+            array.heap_data = (T*)new_data;
+        }
+        array.capacity = new_capacity;
+    }
+
+    template<typename T, u32 N>
+    void sbarray_increase_capacity_min(sbarray<T, N>& array, size_t min_capacity){
+        size_t new_capacity = BEEWAX_INTERNAL::array_next_capacity(max(array.capacity, min_capacity));
+        sbarray_reallocate_to_capacity(array, new_capacity);
+    }
+}
+
+template<typename T, u32 N>
+void sbarray<T, N>::create(){
+    size = (size_t)0u;
+    capacity = (size_t)N;
+}
+
+template<typename T, u32 N>
+void sbarray<T, N>::destroy(){
+    if(!is_inline()) bw_free(heap_data);
+}
+
+template<typename T, u32 N>
+T* sbarray<T, N>::data(){
+    return is_inline() ? (T*)inline_storage : heap_data;
+}
+
+template<typename T, u32 N>
+const T* sbarray<T, N>::data() const{
+    return is_inline() ? (const T*)inline_storage : heap_data;
+}
+
+template<typename T, u32 N>
+bool sbarray<T, N>::is_inline() const{
+    return capacity == (size_t)N;
+}
+
+template<typename T, u32 N>
+const T& sbarray<T, N>::operator[](size_t index) const{
+    assert(index < size);
+    return data()[index];
+}
+
+template<typename T, u32 N>
+T& sbarray<T, N>::operator[](size_t index){
+    assert(index < size);
+    return data()[index];
+}
+
+template<typename T, u32 N>
+T& sbarray<T, N>::push(const T& v){
+    if(size == capacity) BEEWAX_INTERNAL::sbarray_increase_capacity_min(*this, size + 1u);
+    T* ptr = data() + size++;
+    *ptr = v;
+    return *ptr;
+}
+
+template<typename T, u32 N>
+T sbarray<T, N>::pop(){
+    assert(size);
+    --size;
+    return data()[size];
+}
+
+template<typename T, u32 N>
+T& sbarray<T, N>::insert(size_t index, const T& v){
+    assert(!(index > size));
+
+    if(size == capacity) BEEWAX_INTERNAL::sbarray_increase_capacity_min(*this, size + 1u);
+    T* ptr = data();
+    if(index != size) memmove(ptr + index + 1u, ptr + index, (size - index) * sizeof(T));
+    ptr[index] = v;
+    ++size;
+    return ptr[index];
+}
+
+template<typename T, u32 N>
+T* sbarray<T, N>::insert_multi(size_t index, size_t count){
+    assert(!(index > size));
+
+    if(size + count > capacity) BEEWAX_INTERNAL::sbarray_increase_capacity_min(*this, size + count);
+    T* ptr = data();
+    if(index != size) memmove(ptr + index + count, ptr + index, (size - index) * sizeof(T));
+    size += count;
+    return ptr + index;
+}
+
+template<typename T, u32 N>
+void sbarray<T, N>::remove(size_t index){
+    assert(index < size);
+
+    T* ptr = data();
+    if(index < size - 1u) memmove(ptr + index, ptr + index + 1u, (size - index - 1u) * sizeof(T));
+    --size;
+}
+
+template<typename T, u32 N>
+void sbarray<T, N>::remove_multi(size_t index, size_t count){
+    assert(index + count < size + 1u);
+
+    T* ptr = data();
+    if(index + count < size) memmove(ptr + index, ptr + index + count, (size - index - count) * sizeof(T));
+    size -= count;
+}
+
+template<typename T, u32 N>
+void sbarray<T, N>::remove_swap(size_t index){
+    assert(index < size);
+    --size;
+    T* ptr = data();
+    ptr[index] = ptr[size];
+}
+
+template<typename T, u32 N>
+void sbarray<T, N>::resize(size_t new_size){
+    if(new_size > capacity) BEEWAX_INTERNAL::sbarray_increase_capacity_min(*this, new_size);
+    size = new_size;
+}
+
+template<typename T, u32 N>
+void sbarray<T, N>::reserve(size_t new_capacity){
+    if(new_capacity > capacity) BEEWAX_INTERNAL::sbarray_increase_capacity_min(*this, new_capacity);
+}
+
+template<typename T, u32 N>
+void sbarray<T, N>::clear(){
+    size = 0u;
+}
+
+template<typename T, u32 N>
+typename sbarray<T, N>::iterator sbarray<T, N>::begin(){
+    return data();
+}
+
+template<typename T, u32 N>
+typename sbarray<T, N>::iterator sbarray<T, N>::end(){
+    return data() + size;
+}
+
+template<typename T, u32 N>
+const T* sbarray<T, N>::begin() const{
+    return data();
+}
+
+template<typename T, u32 N>
+const T* sbarray<T, N>::end() const{
+    return data() + size;
 }
 
 // ---- hashmap
@@ -172,48 +492,422 @@ inline u32 hashmap_hash(const u32& key){
 inline u32 hashmap_hash(const s32& key){
     return hash_xorshift(*(u32*)&key);
 }
+inline u32 hashmap_hash(const u64& key){
+    // NOTE(hugo): the high bits of the fibonacci hash are the most mixed
+    return (u32)(hash_fibonacci(key) >> 32u);
+}
 inline u32 hashmap_hash(const char* str){
-    return hash_FNV1a_32str(str);
+    return (u32)hash_wyhash((const u8*)str, ::strlen(str));
 }
 inline u32 hashmap_hash(const char* str, size_t strlen){
-    return hash_FNV1a_32ptr((u8*)str, strlen);
+    return (u32)hash_wyhash((const u8*)str, strlen);
 }
 template<typename kT>
 u32 hashmap_hash(const kT*& key){
-    return hash_FNV1a_32ptr((u8*)key, sizeof(kT));
+    return (u32)hash_wyhash((const u8*)key, sizeof(kT));
 }
 
 template<typename kT>
 u32 hashmap_hash(const kT& key){
-    return hash_FNV1a_32ptr((u8*)&key, sizeof(kT));
+    return (u32)hash_wyhash((const u8*)&key, sizeof(kT));
+}
+
+namespace BEEWAX_INTERNAL{
+    // NOTE(hugo): bit i is set when ctrl[i] == tag
+    inline u32 hashmap_match(const u8* group_ctrl, u8 tag){
+#if defined(AVAILABLE_VECTORIZATION)
+        __m128i ctrl = _mm_load_si128((const __m128i*)group_ctrl);
+        return (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)tag)));
+#else
+        u32 output = 0u;
+        for(u32 islot = 0u; islot != hashmap_group_width; ++islot) output |= (u32)(group_ctrl[islot] == tag) << islot;
+        return output;
+#endif
+    }
+
+    // NOTE(hugo): bit i is set when ctrl[i] is empty or deleted ie the high bit is set
+    inline u32 hashmap_match_available(const u8* group_ctrl){
+#if defined(AVAILABLE_VECTORIZATION)
+        return (u32)_mm_movemask_epi8(_mm_load_si128((const __m128i*)group_ctrl));
+#else
+        u32 output = 0u;
+        for(u32 islot = 0u; islot != hashmap_group_width; ++islot) output |= (u32)(group_ctrl[islot] >> 7u) << islot;
+        return output;
+#endif
+    }
+
+    inline size_t hashmap_max_load(size_t nslots){
+        return nslots - nslots / 8u;
+    }
+
+    // NOTE(hugo): the tag and the group are taken from the high bits of a fibonacci hash ie robust to hashmap_hash functions with poorly mixed bits
+    template<typename kT>
+    inline u32 hashmap_slot_hash(const kT& key){
+        return (u32)(hash_fibonacci((u64)hashmap_hash(key)) >> 32u);
+    }
+
+    inline u8 hashmap_hash_tag(u32 hash){
+        return (u8)(hash & 0x7Fu);
+    }
+
+    inline size_t hashmap_hash_group(u32 hash, size_t group_mask){
+        return (size_t)(hash >> 7u) & group_mask;
+    }
+
+    // NOTE(hugo): the slot index depends on the control bytes ie prefetch the group slots to overlap both cache misses
+    template<typename kT, typename vT, typename Allocator>
+    inline void hashmap_prefetch_slots(const hashmap<kT, vT, Allocator>& map, size_t group){
+#if defined(AVAILABLE_VECTORIZATION)
+        _mm_prefetch((const char*)(map.slots + group * hashmap_group_width), _MM_HINT_T0);
+        _mm_prefetch((const char*)(map.slots + group * hashmap_group_width) + 64, _MM_HINT_T0);
+#endif
+    }
+
+    template<typename kT, typename vT, typename Allocator>
+    inline void hashmap_prefetch_group(const hashmap<kT, vT, Allocator>& map, size_t group){
+#if defined(AVAILABLE_VECTORIZATION)
+        _mm_prefetch((const char*)(map.ctrl + group * hashmap_group_width), _MM_HINT_T0);
+#endif
+        hashmap_prefetch_slots(map, group);
+    }
+
+    template<typename kT, typename vT, typename Allocator>
+    typename hashmap<kT, vT, Allocator>::Slot* hashmap_find(const hashmap<kT, vT, Allocator>& map, const kT& key, u32 hash){
+        if(!map.nslots) return nullptr;
+
+        size_t group_mask = map.nslots / hashmap_group_width - 1u;
+        size_t group = hashmap_hash_group(hash, group_mask);
+        u8 tag = hashmap_hash_tag(hash);
+
+        // NOTE(hugo): triangular probing of the groups ie visits every group when the number of groups is a power of two
+        for(size_t step = 1u;; ++step){
+            const u8* group_ctrl = map.ctrl + group * hashmap_group_width;
+            hashmap_prefetch_slots(map, group);
+
+            u32 match = hashmap_match(group_ctrl, tag);
+            while(match){
+                size_t index = group * hashmap_group_width + bitscan_LM(match);
+                if(map.slots[index].key == key) return &map.slots[index];
+                match &= match - 1u;
+            }
+
+            if(hashmap_match(group_ctrl, hashmap_ctrl_empty)) return nullptr;
+            group = (group + step) & group_mask;
+        }
+    }
+
+    // NOTE(hugo): first empty or deleted slot of the probe sequence
+    template<typename kT, typename vT, typename Allocator>
+    size_t hashmap_find_available(const hashmap<kT, vT, Allocator>& map, u32 hash){
+        size_t group_mask = map.nslots / hashmap_group_width - 1u;
+        size_t group = hashmap_hash_group(hash, group_mask);
+
+        for(size_t step = 1u;; ++step){
+            u32 match = hashmap_match_available(map.ctrl + group * hashmap_group_width);
+            if(match) return group * hashmap_group_width + bitscan_LM(match);
+            group = (group + step) & group_mask;
+        }
+    }
+
+    template<typename kT, typename vT, typename Allocator>
+    void hashmap_rehash(hashmap<kT, vT, Allocator>& map, size_t new_nslots){
+        using Slot = typename hashmap<kT, vT, Allocator>::Slot;
+        static_assert(alignof(Slot) <= allocator_policy_alignment);
+        assert(new_nslots >= hashmap_group_width && is_pow2(new_nslots));
+
+        u8* previous_ctrl = map.ctrl;
+        Slot* previous_slots = map.slots;
+        size_t previous_nslots = map.nslots;
+
+        map.ctrl = (u8*)map.allocator.allocate(new_nslots * (1u + sizeof(Slot)));
+        assert(map.ctrl);
+        map.slots = (Slot*)(map.ctrl + new_nslots);
+        map.nslots = new_nslots;
+        map.growth_left = hashmap_max_load(new_nslots) - map.nentries;
+        memset(map.ctrl, hashmap_ctrl_empty, new_nslots);
+
+        for(size_t islot = 0u; islot != previous_nslots; ++islot){
+            if(previous_ctrl[islot] & 0x80u) continue;
+
+            const Slot& slot = previous_slots[islot];
+            u32 hash = hashmap_slot_hash(slot.key);
+            size_t index = hashmap_find_available(map, hash);
+            map.ctrl[index] = hashmap_hash_tag(hash);
+            map.slots[index] = slot;
+        }
+
+        if(previous_ctrl) map.allocator.free(previous_ctrl, previous_nslots * (1u + sizeof(Slot)));
+    }
+
+    // NOTE(hugo): rehashes in place when the deleted slots use more than half of the load ie removes the tombstones
+    template<typename kT, typename vT, typename Allocator>
+    void hashmap_grow(hashmap<kT, vT, Allocator>& map){
+        if(map.nslots && map.nentries <= hashmap_max_load(map.nslots) / 2u)     hashmap_rehash(map, map.nslots);
+        else                                                                    hashmap_rehash(map, max((size_t)hashmap_group_width, map.nslots * 2u));
+    }
+}
+
+template<typename kT, typename vT, typename Allocator>
+void hashmap<kT, vT, Allocator>::create(const Allocator& input_allocator){
+    ctrl = nullptr;
+    slots = nullptr;
+    nslots = 0u;
+    nentries = 0u;
+    growth_left = 0u;
+    allocator = input_allocator;
+}
+
+template<typename kT, typename vT, typename Allocator>
+void hashmap<kT, vT, Allocator>::destroy(){
+    if(ctrl) allocator.free(ctrl, nslots * (1u + sizeof(Slot)));
+}
+
+template<typename kT, typename vT, typename Allocator>
+size_t hashmap<kT, vT, Allocator>::size() const{
+    return nentries;
+}
+
+template<typename kT, typename vT, typename Allocator>
+size_t hashmap<kT, vT, Allocator>::capacity() const{
+    return nslots;
+}
+
+template<typename kT, typename vT, typename Allocator>
+u32 hashmap<kT, vT, Allocator>::get(const kT& key, vT*& v){
+    u32 hash = BEEWAX_INTERNAL::hashmap_slot_hash(key);
+
+    Slot* slot = BEEWAX_INTERNAL::hashmap_find(*this, key, hash);
+    if(slot){
+        v = &slot->value;
+        return 0u;
+    }
+
+    if(!nslots) BEEWAX_INTERNAL::hashmap_grow(*this);
+
+    size_t index = BEEWAX_INTERNAL::hashmap_find_available(*this, hash);
+    if(ctrl[index] == BEEWAX_INTERNAL::hashmap_ctrl_empty){
+        if(!growth_left){
+            BEEWAX_INTERNAL::hashmap_grow(*this);
+            index = BEEWAX_INTERNAL::hashmap_find_available(*this, hash);
+        }
+        if(ctrl[index] == BEEWAX_INTERNAL::hashmap_ctrl_empty) --growth_left;
+    }
+
+    ctrl[index] = BEEWAX_INTERNAL::hashmap_hash_tag(hash);
+    slots[index].key = key;
+    ++nentries;
+
+    v = &slots[index].value;
+    return 1u;
+}
+
+template<typename kT, typename vT, typename Allocator>
+u32 hashmap<kT, vT, Allocator>::search(const kT& key, vT*& v) const{
+    Slot* slot = BEEWAX_INTERNAL::hashmap_find(*this, key, BEEWAX_INTERNAL::hashmap_slot_hash(key));
+    if(slot){
+        v = &slot->value;
+        return 1u;
+    }
+    return 0u;
 }
 
-template<typename kT, typename vT>
-void hashmap<kT, vT>::create(){
+template<typename kT, typename vT, typename Allocator>
+u32 hashmap<kT, vT, Allocator>::search_many(const kT* keys, u32 nkeys, vT** v) const{
+    using namespace BEEWAX_INTERNAL;
+
+    if(!nslots){
+        for(u32 ikey = 0u; ikey != nkeys; ++ikey) v[ikey] = nullptr;
+        return 0u;
+    }
+
+    size_t group_mask = nslots / hashmap_group_width - 1u;
+    u32 nfound = 0u;
+
+    u32 hashes[hashmap_search_batch];
+    for(u32 ibatch = 0u; ibatch < nkeys; ibatch += hashmap_search_batch){
+        u32 batch_nkeys = min(nkeys - ibatch, hashmap_search_batch);
+
+        for(u32 ikey = 0u; ikey != batch_nkeys; ++ikey){
+            hashes[ikey] = hashmap_slot_hash(keys[ibatch + ikey]);
+            hashmap_prefetch_group(*this, hashmap_hash_group(hashes[ikey], group_mask));
+        }
+
+        for(u32 ikey = 0u; ikey != batch_nkeys; ++ikey){
+            Slot* slot = hashmap_find(*this, keys[ibatch + ikey], hashes[ikey]);
+            v[ibatch + ikey] = slot ? &slot->value : nullptr;
+            nfound += slot != nullptr;
+        }
+    }
+
+    return nfound;
+}
+
+template<typename kT, typename vT, typename Allocator>
+u32 hashmap<kT, vT, Allocator>::remove(const kT& key){
+    Slot* slot = BEEWAX_INTERNAL::hashmap_find(*this, key, BEEWAX_INTERNAL::hashmap_slot_hash(key));
+    if(!slot) return 0u;
+
+    // NOTE(hugo): the probe sequences stop at a group with an empty slot ie no key is past this group when it already has one
+    size_t index = (size_t)(slot - slots);
+    const u8* group_ctrl = ctrl + (index & ~(size_t)(BEEWAX_INTERNAL::hashmap_group_width - 1u));
+    if(BEEWAX_INTERNAL::hashmap_match(group_ctrl, BEEWAX_INTERNAL::hashmap_ctrl_empty)){
+        ctrl[index] = BEEWAX_INTERNAL::hashmap_ctrl_empty;
+        ++growth_left;
+    }else{
+        ctrl[index] = BEEWAX_INTERNAL::hashmap_ctrl_deleted;
+    }
+    --nentries;
+
+    return 1u;
+}
+
+template<typename kT, typename vT, typename Allocator>
+u32 hashmap<kT, vT, Allocator>::remove_func(const kT& key, void (*destroy_value)(vT& v)){
+    vT* value;
+    if(!search(key, value)) return 0u;
+
+    destroy_value(*value);
+    return remove(key);
+}
+
+template<typename kT, typename vT, typename Allocator>
+void hashmap<kT, vT, Allocator>::reserve(size_t new_capacity){
+    if(new_capacity <= BEEWAX_INTERNAL::hashmap_max_load(nslots)) return;
+
+    size_t new_nslots = BEEWAX_INTERNAL::hashmap_group_width;
+    while(BEEWAX_INTERNAL::hashmap_max_load(new_nslots) < new_capacity) new_nslots *= 2u;
+    BEEWAX_INTERNAL::hashmap_rehash(*this, new_nslots);
+}
+
+template<typename kT, typename vT, typename Allocator>
+void hashmap<kT, vT, Allocator>::clear(){
+    if(!nslots) return;
+
+    memset(ctrl, BEEWAX_INTERNAL::hashmap_ctrl_empty, nslots);
+    nentries = 0u;
+    growth_left = BEEWAX_INTERNAL::hashmap_max_load(nslots);
+}
+
+// -- iterator
+
+template<typename kT, typename vT, typename Allocator>
+kT& hashmap<kT, vT, Allocator>::iterator::key(){
+    return map->slots[index].key;
+}
+
+template<typename kT, typename vT, typename Allocator>
+const kT& hashmap<kT, vT, Allocator>::iterator::key() const{
+    return map->slots[index].key;
+}
+
+template<typename kT, typename vT, typename Allocator>
+vT& hashmap<kT, vT, Allocator>::iterator::value(){
+    return map->slots[index].value;
+}
+
+template<typename kT, typename vT, typename Allocator>
+const vT& hashmap<kT, vT, Allocator>::iterator::value() const{
+    return map->slots[index].value;
+}
+
+template<typename kT, typename vT, typename Allocator>
+typename hashmap<kT, vT, Allocator>::iterator& hashmap<kT, vT, Allocator>::iterator::operator*(){
+    return *this;
+}
+
+template<typename kT, typename vT, typename Allocator>
+const typename hashmap<kT, vT, Allocator>::iterator& hashmap<kT, vT, Allocator>::iterator::operator*() const{
+    return *this;
+}
+
+template<typename kT, typename vT, typename Allocator>
+typename hashmap<kT, vT, Allocator>::iterator& hashmap<kT, vT, Allocator>::iterator::operator++(){
+    while(index != map->nslots && (++index, index != map->nslots && (map->ctrl[index] & 0x80u)));
+    return *this;
+}
+
+template<typename kT, typename vT, typename Allocator>
+bool hashmap<kT, vT, Allocator>::iterator::operator!=(const hashmap<kT, vT, Allocator>::iterator& rhs) const{
+    return index != rhs.index || map != rhs.map;
+}
+
+template<typename kT, typename vT, typename Allocator>
+typename hashmap<kT, vT, Allocator>::iterator hashmap<kT, vT, Allocator>::begin(){
+    iterator iter;
+    iter.map = this;
+
+    size_t index = 0u;
+    while(index != nslots && (ctrl[index] & 0x80u)) ++index;
+    iter.index = index;
+
+    return iter;
+}
+
+template<typename kT, typename vT, typename Allocator>
+typename hashmap<kT, vT, Allocator>::iterator hashmap<kT, vT, Allocator>::end(){
+    iterator iter;
+    iter.map = this;
+    iter.index = nslots;
+    return iter;
+}
+
+template<typename kT, typename vT, typename Allocator>
+const typename hashmap<kT, vT, Allocator>::iterator hashmap<kT, vT, Allocator>::begin() const{
+    return const_cast<hashmap*>(this)->begin();
+}
+
+template<typename kT, typename vT, typename Allocator>
+const typename hashmap<kT, vT, Allocator>::iterator hashmap<kT, vT, Allocator>::end() const{
+    return const_cast<hashmap*>(this)->end();
+}
+
+// ---- khashmap
+
+template<typename kT, typename vT, typename Allocator>
+void khashmap<kT, vT, Allocator>::create(const Allocator& allocator){
     // NOTE(hugo): kh_init without heap allocation
-    memset(&data, 0x00, sizeof(data));
+    memset((void*)&data, 0x00, sizeof(data));
+    data.allocator = allocator;
 }
 
-template<typename kT, typename vT>
-void hashmap<kT, vT>::destroy(){
+template<typename kT, typename vT, typename Allocator>
+void khashmap<kT, vT, Allocator>::destroy(){
     // NOTE(hugo): kh_destroy without heap allocation
+    kh_kinstance_t* h = &data;
     if(data.keys)   kfree((void*)data.keys);
     if(data.flags)  kfree((void*)data.flags);
     if(data.vals)   kfree((void*)data.vals);
 }
 
-template<typename kT, typename vT>
-size_t hashmap<kT, vT>::size(){
+template<typename kT, typename vT, typename Allocator>
+void* khashmap<kT, vT, Allocator>::khash_reallocate(kh_kinstance_t* h, void* ptr, size_t bytesize){
+    size_t previous_bytesize = 0u;
+    if(ptr == (void*)h->keys)       previous_bytesize = h->n_buckets * sizeof(kT);
+    else if(ptr == (void*)h->vals)  previous_bytesize = h->n_buckets * sizeof(vT);
+    return h->allocator.reallocate(ptr, previous_bytesize, bytesize);
+}
+
+template<typename kT, typename vT, typename Allocator>
+void khashmap<kT, vT, Allocator>::khash_free(kh_kinstance_t* h, void* ptr){
+    size_t bytesize = 0u;
+    if(ptr == (void*)h->keys)       bytesize = h->n_buckets * sizeof(kT);
+    else if(ptr == (void*)h->vals)  bytesize = h->n_buckets * sizeof(vT);
+    else if(ptr == (void*)h->flags) bytesize = __ac_fsize(h->n_buckets) * sizeof(khint32_t);
+    h->allocator.free(ptr, bytesize);
+}
+
+template<typename kT, typename vT, typename Allocator>
+size_t khashmap<kT, vT, Allocator>::size(){
     return (size_t)data.size;
 }
 
-template<typename kT, typename vT>
-size_t hashmap<kT, vT>::capacity(){
+template<typename kT, typename vT, typename Allocator>
+size_t khashmap<kT, vT, Allocator>::capacity(){
     return (size_t)data.nbuckets;
 }
 
-template<typename kT, typename vT>
-u32 hashmap<kT, vT>::get(const kT& key, vT*& v){
+template<typename kT, typename vT, typename Allocator>
+u32 khashmap<kT, vT, Allocator>::get(const kT& key, vT*& v){
     s32 kreturn;
     khiter_t iter = kh_put(kinstance, &data, key, &kreturn);
     assert(kreturn != -1);
@@ -222,8 +916,8 @@ u32 hashmap<kT, vT>::get(const kT& key, vT*& v){
     return kreturn > 0 ? 1u : 0u;
 }
 
-template<typename kT, typename vT>
-u32 hashmap<kT, vT>::search(const kT& key, vT*& v) const{
+template<typename kT, typename vT, typename Allocator>
+u32 khashmap<kT, vT, Allocator>::search(const kT& key, vT*& v) const{
     khiter_t iter = kh_get(kinstance, &data, key);
     if(iter != kh_end(&data)){
         v = &(kh_value(&data, iter));
@@ -232,8 +926,8 @@ u32 hashmap<kT, vT>::search(const kT& key, vT*& v) const{
     return 0u;
 }
 
-template<typename kT, typename vT>
-u32 hashmap<kT, vT>::remove(const kT& key){
+template<typename kT, typename vT, typename Allocator>
+u32 khashmap<kT, vT, Allocator>::remove(const kT& key){
     khiter_t iter = kh_get(kinstance, &data, key);
     if(iter != kh_end(&data)){
         kh_del(kinstance, &data, iter);
@@ -242,8 +936,8 @@ u32 hashmap<kT, vT>::remove(const kT& key){
     return 0u;
 }
 
-template<typename kT, typename vT>
-u32 hashmap<kT, vT>::remove_func(const kT& key, void (*destroy_value)(vT& v)){
+template<typename kT, typename vT, typename Allocator>
+u32 khashmap<kT, vT, Allocator>::remove_func(const kT& key, void (*destroy_value)(vT& v)){
     khiter_t iter = kh_get(kinstance, &data, key);
     if(iter != kh_end(&data)){
         destroy_value(kh_value(&data, iter));
@@ -253,61 +947,61 @@ u32 hashmap<kT, vT>::remove_func(const kT& key, void (*destroy_value)(vT& v)){
     return 0u;
 }
 
-template<typename kT, typename vT>
-void hashmap<kT, vT>::reserve(size_t new_capacity){
+template<typename kT, typename vT, typename Allocator>
+void khashmap<kT, vT, Allocator>::reserve(size_t new_capacity){
     if(new_capacity > data.nbuckets) kh_resize(kinstance, &data, new_capacity);
 }
 
-template<typename kT, typename vT>
-void hashmap<kT, vT>::clear(){
+template<typename kT, typename vT, typename Allocator>
+void khashmap<kT, vT, Allocator>::clear(){
     kh_clear(kinstance, &data);
 }
 
 // -- iterator
 
-template<typename kT, typename vT>
-kT& hashmap<kT, vT>::iterator::key(){
+template<typename kT, typename vT, typename Allocator>
+kT& khashmap<kT, vT, Allocator>::iterator::key(){
     return kh_key(ptr, iter);
 }
 
-template<typename kT, typename vT>
-const kT& hashmap<kT, vT>::iterator::key() const{
+template<typename kT, typename vT, typename Allocator>
+const kT& khashmap<kT, vT, Allocator>::iterator::key() const{
     return kh_key(ptr, iter);
 }
 
-template<typename kT, typename vT>
-vT& hashmap<kT, vT>::iterator::value(){
+template<typename kT, typename vT, typename Allocator>
+vT& khashmap<kT, vT, Allocator>::iterator::value(){
     return kh_value(ptr, iter);
 }
 
-template<typename kT, typename vT>
-const vT& hashmap<kT, vT>::iterator::value() const{
+template<typename kT, typename vT, typename Allocator>
+const vT& khashmap<kT, vT, Allocator>::iterator::value() const{
     return kh_value(ptr, iter);
 }
 
-template<typename kT, typename vT>
-typename hashmap<kT, vT>::iterator& hashmap<kT, vT>::iterator::operator*(){
+template<typename kT, typename vT, typename Allocator>
+typename khashmap<kT, vT, Allocator>::iterator& khashmap<kT, vT, Allocator>::iterator::operator*(){
     return *this;
 }
 
-template<typename kT, typename vT>
-const typename hashmap<kT, vT>::iterator& hashmap<kT, vT>::iterator::operator*() const{
+template<typename kT, typename vT, typename Allocator>
+const typename khashmap<kT, vT, Allocator>::iterator& khashmap<kT, vT, Allocator>::iterator::operator*() const{
     return *this;
 }
 
-template<typename kT, typename vT>
-typename hashmap<kT, vT>::iterator& hashmap<kT, vT>::iterator::operator++(){
+template<typename kT, typename vT, typename Allocator>
+typename khashmap<kT, vT, Allocator>::iterator& khashmap<kT, vT, Allocator>::iterator::operator++(){
     while(iter != kh_end(ptr) && (++iter, !kh_exist(ptr, iter)));
     return *this;
 }
 
-template<typename kT, typename vT>
-bool hashmap<kT, vT>::iterator::operator!=(const hashmap<kT, vT>::iterator& rhs) const{
+template<typename kT, typename vT, typename Allocator>
+bool khashmap<kT, vT, Allocator>::iterator::operator!=(const khashmap<kT, vT, Allocator>::iterator& rhs) const{
     return iter != rhs.iter || ptr != rhs.ptr;
 }
 
-template<typename kT, typename vT>
-typename hashmap<kT, vT>::iterator hashmap<kT, vT>::begin(){
+template<typename kT, typename vT, typename Allocator>
+typename khashmap<kT, vT, Allocator>::iterator khashmap<kT, vT, Allocator>::begin(){
     iterator iter;
     iter.ptr = &data;
 
@@ -318,16 +1012,16 @@ typename hashmap<kT, vT>::iterator hashmap<kT, vT>::begin(){
     return iter;
 }
 
-template<typename kT, typename vT>
-typename hashmap<kT, vT>::iterator hashmap<kT, vT>::end(){
+template<typename kT, typename vT, typename Allocator>
+typename khashmap<kT, vT, Allocator>::iterator khashmap<kT, vT, Allocator>::end(){
     iterator iter;
     iter.ptr = &data;
     iter.iter = kh_end(&data);
     return iter;
 }
 
-template<typename kT, typename vT>
-const typename hashmap<kT, vT>::iterator hashmap<kT, vT>::begin() const{
+template<typename kT, typename vT, typename Allocator>
+const typename khashmap<kT, vT, Allocator>::iterator khashmap<kT, vT, Allocator>::begin() const{
     iterator iter;
     iter.ptr = &data;
 
@@ -338,8 +1032,8 @@ const typename hashmap<kT, vT>::iterator hashmap<kT, vT>::begin() const{
     return iter;
 }
 
-template<typename kT, typename vT>
-const typename hashmap<kT, vT>::iterator hashmap<kT, vT>::end() const{
+template<typename kT, typename vT, typename Allocator>
+const typename khashmap<kT, vT, Allocator>::iterator khashmap<kT, vT, Allocator>::end() const{
     iterator iter;
     iter.ptr = &data;
     iter.iter = kh_end(&data);
@@ -108,6 +108,7 @@ namespace BEEWAX_INTERNAL{
         File_Path file;
         u32 line;
         const char* label;
+        String_ID label_id;
         DEV_Tweakable_Type type;
         DEV_Tweakable_Value value;
     };
@@ -115,9 +116,9 @@ namespace BEEWAX_INTERNAL{
     static array<DEV_Tweakable_Entry> DEV_tweakable_entries;
     static array<void*> DEV_tweakables_malloc;
 
-    static u32 DEV_search_tweakable_entry(const char* label){
+    static u32 DEV_search_tweakable_entry(String_ID label_id){
         for(u32 itweak = 0u; itweak != DEV_tweakable_entries.size; ++itweak){
-            if(DEV_tweakable_entries[itweak].label == label) return itweak;
+            if(DEV_tweakable_entries[itweak].label_id == label_id) return itweak;
         }
         return UINT32_MAX;
     }
@@ -135,16 +136,31 @@ namespace BEEWAX_INTERNAL{
         }
         DEV_tweakables_malloc.clear();
 
-        hashmap<File_Path, File_Data> path_to_content;
+        // NOTE(hugo): the files are read once per reparse in the scratch arena
+        struct File_Content{
+            const File_Path* file;
+            File_Data data;
+        };
+
+        Scratch_Scope scratch;
+        File_Content* file_contents = scratch.allocate<File_Content>(DEV_tweakable_entries.size);
+        u32 nfiles = 0u;
+
         for(u32 ientry = 0u; ientry != DEV_tweakable_entries.size; ++ientry){
             DEV_Tweakable_Entry& entry = DEV_tweakable_entries[ientry];
 
-            // NOTE(hugo): register the file in the hashmap and read it to memory when necessary
-            bool file_not_loaded;
-            File_Data* file_content;
-            path_to_content.get(entry.file, file_content);
-            if(file_content){
-                *file_content = read_file(entry.file, "r");
+            // NOTE(hugo): search the file and read it to memory when necessary
+            File_Data* file_content = nullptr;
+            for(u32 ifile = 0u; ifile != nfiles; ++ifile){
+                if(*file_contents[ifile].file == entry.file){
+                    file_content = &file_contents[ifile].data;
+                    break;
+                }
+            }
+            if(!file_content){
+                file_contents[nfiles].file = &entry.file;
+                file_contents[nfiles].data = read_file_cstring(entry.file, scratch);
+                file_content = &file_contents[nfiles++].data;
             }
 
             // NOTE(hugo): go to the line of the DEV_Tweak
@@ -253,11 +269,6 @@ namespace BEEWAX_INTERNAL{
             }
         }
 
-        //NOTE(hugo): free the files from memory
-        for(auto& to_free : path_to_content){
-            bw_free(to_free.value().data);
-        }
-        path_to_content.destroy();
     }
 
     static int DEV_tweakable_ImGui_InputTexCallback(ImGuiInputTextCallbackData* data){
@@ -340,13 +351,14 @@ namespace BEEWAX_INTERNAL{
     using namespace BEEWAX_INTERNAL;                                                                                    \
     static u32 DEV_tweakable_entry_index = UINT_MAX;                                                                    \
     if(DEV_tweakable_entry_index == UINT_MAX){                                                                          \
-        DEV_tweakable_entry_index = DEV_search_tweakable_entry(LABEL);                                                  \
+        DEV_tweakable_entry_index = DEV_search_tweakable_entry(STRING_ID(LABEL));                                       \
     }                                                                                                                   \
     if(DEV_tweakable_entry_index == UINT_MAX){                                                                          \
         DEV_tweakable_entry_index = DEV_get_new_tweakable_entry();                                                      \
         DEV_tweakable_entries[DEV_tweakable_entry_index].file = __FILE__;                                               \
         DEV_tweakable_entries[DEV_tweakable_entry_index].line = __LINE__;                                               \
         DEV_tweakable_entries[DEV_tweakable_entry_index].label = LABEL;                                                 \
+        DEV_tweakable_entries[DEV_tweakable_entry_index].label_id = STRING_ID(LABEL);                                   \
         DEV_tweakable_entries[DEV_tweakable_entry_index].type = CONCATENATE(Tweakable_, TYPE);                          \
         CONCATENATE(DEV_Tweak_Create_, TYPE)(DEV_tweakable_entries[DEV_tweakable_entry_index].value, DEFAULT_VALUE);    \
     }                                                                                                                   \
@@ -70,6 +70,12 @@ void Engine::create(const Engine_Config& iconfig){
 
     // --
 
+    worker_pool.create();
+
+    frame_allocator.create(MEGABYTES(64u));
+
+    // --
+
     scene_manager.create();
 
     // ---- dev tools
@@ -115,6 +121,10 @@ void Engine::destroy(){
 
     scene_manager.destroy();
 
+    frame_allocator.destroy();
+
+    worker_pool.destroy();
+
     audio.destroy();
     render_layer.free_render_target(render_target);
     render_layer.destroy();
@@ -127,6 +137,9 @@ void Engine::destroy(){
 
     action_manager.destroy();
 
+    destroy_string_table();
+    destroy_scratch_arena();
+
     // ---- external
 
     SDL_Quit();
@@ -213,6 +226,9 @@ namespace BEEWAX_INTERNAL{
         if(!engine.scene_manager.has_scene()) return Engine_Code::No_Scene;
         Engine_Code error_code = Engine_Code::Nothing;
 
+        engine.frame_allocator.new_frame();
+        DEV_Memtracker_New_Frame();
+
         error_code = Engine_process_event(engine);
         if(error_code != Engine_Code::Nothing) return error_code;
 
@@ -28,6 +28,11 @@ struct Engine{
 
     Audio_Player audio;
 
+    Worker_Pool worker_pool;
+
+    // NOTE(hugo): reset at the start of every frame ; allocations remain valid until the end of the next frame
+    Frame_Allocator frame_allocator;
+
     Scene_Manager scene_manager;
 };
 
@@ -49,6 +49,30 @@ File_Data read_file_cstring(const File_Path& path){
     return output;
 }
 
+File_Data read_file_cstring(const File_Path& path, Scratch_Scope& scratch){
+    FILE* f = fopen(path.data, "r");
+    ENGINE_CHECK(f != NULL, "read_file_cstring(%s) FAILED - returning nullptr", path.data);
+
+    File_Data output;
+
+    fseek(f, 0, SEEK_END);
+    s64 fsize = ftell(f);
+    assert(fsize == 0u || fsize > 0u);
+    fseek(f, 0, SEEK_SET);
+
+    output.data = scratch.allocate(fsize + 1u, alignof(char));
+
+    size_t fread_size = fread(output.data, sizeof(char), (size_t)fsize, f);
+    assert((size_t)fsize >= fread_size);
+
+    ((char*)output.data)[fread_size] = '\0';
+    output.bytesize = fread_size + 1u;
+
+    fclose(f);
+
+    return output;
+}
+
 void write_file(const File_Path& path, const u8* data, size_t bytesize){
     FILE* f = fopen(path.data, "wb");
     ENGINE_CHECK(f != NULL, "write_file(%s) FAILED - aborting write", path.data);
@@ -56,3 +80,112 @@ void write_file(const File_Path& path, const u8* data, size_t bytesize){
     fwrite(data, 1, bytesize, f);
     fclose(f);
 }
+
+bool replace_file(const File_Path& src, const File_Path& dst){
+#if defined(PLATFORM_WINDOWS)
+    if(!MoveFileExA(src.data, dst.data, MOVEFILE_REPLACE_EXISTING)){
+        LOG_ERROR("replace_file(%s, %s) FAILED - MoveFileExA", src.data, dst.data);
+        return false;
+    }
+
+#elif defined(PLATFORM_LINUX)
+    if(rename(src.data, dst.data) == -1){
+        LOG_ERROR("replace_file(%s, %s) FAILED - rename", src.data, dst.data);
+        return false;
+    }
+
+#else
+    static_assert(false, "replace_file() is not implemented for this platform");
+
+#endif
+
+    return true;
+}
+
+File_Mapping map_file(const File_Path& path){
+    File_Mapping output;
+    output.data = nullptr;
+    output.bytesize = 0u;
+
+#if defined(PLATFORM_WINDOWS)
+    HANDLE file = CreateFileA(path.data, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if(file == INVALID_HANDLE_VALUE){
+        LOG_ERROR("map_file(%s) FAILED - CreateFileA", path.data);
+        return output;
+    }
+
+    LARGE_INTEGER file_size;
+    if(!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0){
+        LOG_ERROR("map_file(%s) FAILED - empty file", path.data);
+        CloseHandle(file);
+        return output;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    CloseHandle(file);
+    if(mapping == NULL){
+        LOG_ERROR("map_file(%s) FAILED - CreateFileMappingA", path.data);
+        return output;
+    }
+
+    // NOTE(hugo): the view keeps a reference to the mapping object
+    void* data = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+    CloseHandle(mapping);
+    if(data == NULL){
+        LOG_ERROR("map_file(%s) FAILED - MapViewOfFile", path.data);
+        return output;
+    }
+
+    output.data = data;
+    output.bytesize = (size_t)file_size.QuadPart;
+
+#elif defined(PLATFORM_LINUX)
+    int file = open(path.data, O_RDONLY);
+    if(file == -1){
+        LOG_ERROR("map_file(%s) FAILED - open", path.data);
+        return output;
+    }
+
+    struct stat file_stat;
+    if(fstat(file, &file_stat) == -1 || file_stat.st_size == 0){
+        LOG_ERROR("map_file(%s) FAILED - empty file", path.data);
+        close(file);
+        return output;
+    }
+
+    // NOTE(hugo): the mapping remains valid after closing the file descriptor
+    void* data = mmap(NULL, (size_t)file_stat.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+    close(file);
+    if(data == MAP_FAILED){
+        LOG_ERROR("map_file(%s) FAILED - mmap", path.data);
+        return output;
+    }
+
+    output.data = data;
+    output.bytesize = (size_t)file_stat.st_size;
+
+#else
+    static_assert(false, "map_file() is not implemented for this platform");
+
+#endif
+
+    return output;
+}
+
+void unmap_file(File_Mapping& mapping){
+    if(!mapping.data) return;
+
+#if defined(PLATFORM_WINDOWS)
+    UnmapViewOfFile(mapping.data);
+
+#elif defined(PLATFORM_LINUX)
+    munmap(mapping.data, mapping.bytesize);
+
+#else
+    static_assert(false, "unmap_file() is not implemented for this platform");
+
+#endif
+
+    mapping.data = nullptr;
+    mapping.bytesize = 0u;
+}
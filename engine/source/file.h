@@ -13,9 +13,25 @@ struct File_Data{
 // NOTE(hugo): explicit free required
 File_Data read_file(const File_Path& path, const char* mode);
 File_Data read_file_cstring(const File_Path& path);
+// NOTE(hugo): allocated in the scratch scope ie released with the scope
+File_Data read_file_cstring(const File_Path& path, Scratch_Scope& scratch);
 
 void write_file(const File_Path& path, const u8* data, size_t bytesize);
 
+// NOTE(hugo): renames /src/ to /dst/ and replaces /dst/ when it exists ; returns false on failure
+// /!\ fails on windows while /dst/ is mapped /!\ a mapping of /dst/ on linux keeps the previous content
+bool replace_file(const File_Path& src, const File_Path& dst);
+
+// NOTE(hugo): private copy-on-write mapping of the whole file ie writes to the mapping are not written to the file
+// data is nullptr when the mapping failed ; explicit unmap required
+struct File_Mapping{
+    void* data;
+    size_t bytesize;
+};
+
+File_Mapping map_file(const File_Path& path);
+void unmap_file(File_Mapping& mapping);
+
 // ---- packing / unpacking
 
 template<typename T>
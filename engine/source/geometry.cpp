@@ -342,10 +342,8 @@ size_t triangulation_2D_bytesize(u32 nvertices){
 void triangulation_2D_v0(u32 nvertices, vec2* vertices, u32* nindices){
     assert(nvertices > 2u);
 
-    BEEWAX_INTERNAL::trig_2D_LLE* connectivity_LL = (BEEWAX_INTERNAL::trig_2D_LLE*)bw_malloc(nvertices * sizeof(BEEWAX_INTERNAL::trig_2D_LLE));
-    DEFER{
-        bw_free((void*)connectivity_LL);
-    };
+    Scratch_Scope scratch;
+    BEEWAX_INTERNAL::trig_2D_LLE* connectivity_LL = scratch.allocate<BEEWAX_INTERNAL::trig_2D_LLE>(nvertices);
 
     auto is_reflex = [&](u32 iprev, u32 ivert, u32 inext){
         return side_point_segment(vertices[iprev], vertices[ivert], vertices[inext]) > 0.f;
@@ -414,13 +412,10 @@ void triangulation_2D_v1(u32 nvertices, vec2* vertices, u32* nindices){
     constexpr u32 not_reflex = UINT32_MAX;
     constexpr u32 end_reflex_LL = UINT32_MAX - 1u;
 
-    BEEWAX_INTERNAL::trig_2D_LLE* connectivity_LL = (BEEWAX_INTERNAL::trig_2D_LLE*)bw_malloc(nvertices * sizeof(BEEWAX_INTERNAL::trig_2D_LLE));
-    u32* reflex_LL = (u32*)bw_malloc(nvertices * sizeof(u32));
+    Scratch_Scope scratch;
+    BEEWAX_INTERNAL::trig_2D_LLE* connectivity_LL = scratch.allocate<BEEWAX_INTERNAL::trig_2D_LLE>(nvertices);
+    u32* reflex_LL = scratch.allocate<u32>(nvertices);
     memset(reflex_LL, 0xFF, nvertices * sizeof(u32));
-    DEFER{
-        bw_free((void*)reflex_LL);
-        bw_free((void*)connectivity_LL);
-    };
 
     auto is_reflex = [&](u32 iprev, u32 ivert, u32 inext){
         return side_point_segment(vertices[iprev], vertices[ivert], vertices[inext]) > 0.f;
@@ -155,6 +155,100 @@ u32 hash_murmur3(const u8* data, const size_t bytesize, const u32 seed){
     return hash;
 }
 
+namespace BEEWAX_INTERNAL{
+    constexpr u64 wyhash_secret[4u] = {0x2d358dccaa6c78a5u, 0x8bb84b93962eacc9u, 0x4b33a62ed433d4a3u, 0x4d5a2da51de1aa47u};
+
+    // NOTE(hugo): 64 x 64 -> 128 bits multiplication ; A = low bits, B = high bits
+    static inline void wyhash_mum(u64& A, u64& B){
+#if defined(COMPILER_MSVC)
+        A = _umul128(A, B, &B);
+#elif defined(COMPILER_GCC)
+        __uint128_t product = (__uint128_t)A * (__uint128_t)B;
+        A = (u64)product;
+        B = (u64)(product >> 64u);
+#else
+        static_assert(false, "wyhash_mum() not implemented");
+#endif
+    }
+
+    static inline u64 wyhash_mix(u64 A, u64 B){
+        wyhash_mum(A, B);
+        return A ^ B;
+    }
+
+    // NOTE(hugo): unaligned little endian reads
+    static inline u64 wyhash_read8(const u8* ptr){
+        u64 output;
+        memcpy(&output, ptr, sizeof(u64));
+        return output;
+    }
+    static inline u64 wyhash_read4(const u8* ptr){
+        u32 output;
+        memcpy(&output, ptr, sizeof(u32));
+        return output;
+    }
+    // NOTE(hugo): first, middle and last byte for 1 to 3 bytes
+    static inline u64 wyhash_read3(const u8* ptr, size_t bytesize){
+        return ((u64)ptr[0u] << 16u) | ((u64)ptr[bytesize >> 1u] << 8u) | (u64)ptr[bytesize - 1u];
+    }
+}
+
+u64 hash_wyhash(const u8* data, const size_t bytesize, const u64 seed){
+    using namespace BEEWAX_INTERNAL;
+
+    const u8* ptr = data;
+    u64 state = seed ^ wyhash_mix(seed ^ wyhash_secret[0u], wyhash_secret[1u]);
+    u64 A;
+    u64 B;
+
+    // NOTE(hugo): up to 16 bytes with two possibly overlapping reads
+    if(bytesize <= 16u){
+        if(bytesize >= 4u){
+            size_t offset = (bytesize >> 3u) << 2u;
+            A = (wyhash_read4(ptr) << 32u) | wyhash_read4(ptr + offset);
+            B = (wyhash_read4(ptr + bytesize - 4u) << 32u) | wyhash_read4(ptr + bytesize - 4u - offset);
+        }else if(bytesize > 0u){
+            A = wyhash_read3(ptr, bytesize);
+            B = 0u;
+        }else{
+            A = 0u;
+            B = 0u;
+        }
+
+    }else{
+        size_t remaining = bytesize;
+
+        // NOTE(hugo): three independent lanes of 16 bytes
+        if(remaining > 48u){
+            u64 state_lane1 = state;
+            u64 state_lane2 = state;
+            do{
+                state = wyhash_mix(wyhash_read8(ptr) ^ wyhash_secret[1u], wyhash_read8(ptr + 8u) ^ state);
+                state_lane1 = wyhash_mix(wyhash_read8(ptr + 16u) ^ wyhash_secret[2u], wyhash_read8(ptr + 24u) ^ state_lane1);
+                state_lane2 = wyhash_mix(wyhash_read8(ptr + 32u) ^ wyhash_secret[3u], wyhash_read8(ptr + 40u) ^ state_lane2);
+                ptr += 48u;
+                remaining -= 48u;
+            }while(remaining > 48u);
+            state ^= state_lane1 ^ state_lane2;
+        }
+
+        while(remaining > 16u){
+            state = wyhash_mix(wyhash_read8(ptr) ^ wyhash_secret[1u], wyhash_read8(ptr + 8u) ^ state);
+            ptr += 16u;
+            remaining -= 16u;
+        }
+
+        // NOTE(hugo): last 16 bytes, overlapping the previous step
+        A = wyhash_read8(ptr + remaining - 16u);
+        B = wyhash_read8(ptr + remaining - 8u);
+    }
+
+    A ^= wyhash_secret[1u];
+    B ^= state;
+    wyhash_mum(A, B);
+    return wyhash_mix(A ^ wyhash_secret[0u] ^ (u64)bytesize, B ^ wyhash_secret[1u]);
+}
+
 u32 hash_combine(const u32 current, const u32 to_append){
     return current ^ to_append + 0x9e3779b9 + (current << 6u) + (current >> 2u);
 }
@@ -25,6 +25,11 @@ u64 hash_xorshift(const u64 data);
 // REF(hugo): https://github.com/aappleby/smhasher/blob/master/src/MurmurHash3.cpp
 u32 hash_murmur3(const u8* data, const size_t bytesize, const u32 seed);
 
+// REF(hugo): https://github.com/wangyi-fudan/wyhash
+// NOTE(hugo): reads 8 or 16 bytes per step instead of one ie use for keys larger than a few bytes
+// the seed selects an independent hash function
+u64 hash_wyhash(const u8* data, const size_t bytesize, const u64 seed = 0u);
+
 u32 hash_combine(const u32 current, const u32 to_append);
 
 #endif
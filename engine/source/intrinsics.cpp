@@ -33,7 +33,7 @@ u32 bitscan_ML(u32 value){
     u32 output;
     static_assert(sizeof(u32) == sizeof(unsigned long));
     _BitScanReverse((unsigned long*)&output, value);
-    return output;
+    return 31u - output;
 #elif defined(COMPILER_GCC)
     return __builtin_clz(value);
 #else
@@ -47,10 +47,10 @@ u32 bitscan_LM(u64 value){
 #if defined(COMPILER_MSVC)
     u32 output;
     static_assert(sizeof(u64) == sizeof(unsigned __int64));
-    _BitScanForward((unsigned long*)&output, value);
+    _BitScanForward64((unsigned long*)&output, value);
     return output;
 #elif defined(COMPILER_GCC)
-    return __builtin_ctz(value);
+    return __builtin_ctzll(value);
 #else
     static_assert(false, "bitsan_LM(u64) not implemented");
 #endif
@@ -62,15 +62,37 @@ u32 bitscan_ML(u64 value){
 #if defined(COMPILER_MSVC)
     u32 output;
     static_assert(sizeof(u64) == sizeof(unsigned __int64));
-    _BitScanReverse((unsigned long*)&output, value);
-    return output;
+    _BitScanReverse64((unsigned long*)&output, value);
+    return 63u - output;
 #elif defined(COMPILER_GCC)
-    return __builtin_clz(value);
+    return __builtin_clzll(value);
 #else
     static_assert(false, "bitscan_ML(u64) not implemented");
 #endif
 }
 
+// ---- popcount
+
+u32 popcount(u32 value){
+#if defined(COMPILER_MSVC)
+    return __popcnt(value);
+#elif defined(COMPILER_GCC)
+    return __builtin_popcount(value);
+#else
+    static_assert(false, "popcount(u32) not implemented");
+#endif
+}
+
+u32 popcount(u64 value){
+#if defined(COMPILER_MSVC)
+    return (u32)__popcnt64(value);
+#elif defined(COMPILER_GCC)
+    return __builtin_popcountll(value);
+#else
+    static_assert(false, "popcount(u64) not implemented");
+#endif
+}
+
 // ---- cpu capabilities
 
 #if defined(AVAILABLE_CPUID)
@@ -6,6 +6,7 @@
 // NOTE(hugo): memory order acquire = memory read / write after the instruction are kept after
 //             memory order release = memory read / write before the instruction are kept before
 // NOTE(hugo): those have acquire & release memory barriers
+// NOTE(hugo): stores /new_value/ when the value is /previous_value/ ; returns the value before the instruction
 template<typename T>
 inline T atomic_compare_exchange(volatile T* atomic, T new_value, T previous_value);
 template<typename T>
@@ -14,6 +15,9 @@ template<typename T>
 inline T atomic_get(volatile T* atomic);
 template<typename T>
 inline void atomic_set(volatile T* atomic, T new_value);
+// NOTE(hugo): returns the value before the addition
+template<typename T>
+inline T atomic_add(volatile T* atomic, T value);
 
 // ---- cycle counter
 
@@ -36,6 +40,12 @@ u32 bitscan_ML(u32 value);
 u32 bitscan_LM(u64 value);
 u32 bitscan_ML(u64 value);
 
+// ---- popcount
+
+// NOTE(hugo): returns the number of one bits
+u32 popcount(u32 value);
+u32 popcount(u64 value);
+
 // ----
 
 // ---- cpu capabilities
@@ -7,18 +7,19 @@ inline T atomic_compare_exchange(volatile T* atomic, T new_value, T previous_val
 
 #if defined(COMPILER_MSVC)
     if constexpr (sizeof(T) == 1u)
-        return _InterlockedCompareExchange8(atomic, new_value, previous_value);
+        return (T)_InterlockedCompareExchange8((volatile char*)atomic, (char)new_value, (char)previous_value);
     else if constexpr (sizeof(T) == 2u)
-        return _InterlockedCompareExchange16(atomic, new_value, previous_value);
+        return (T)_InterlockedCompareExchange16((volatile short*)atomic, (short)new_value, (short)previous_value);
     else if constexpr (sizeof(T) == 4u)
-        return _InterlockedCompareExchange(atomic, new_value, previous_value);
+        return (T)_InterlockedCompareExchange((volatile long*)atomic, (long)new_value, (long)previous_value);
     else if constexpr (sizeof(T) == 8u)
-        return _InterlockedCompareExchange64(atomic, new_value, previous_value);
+        return (T)_InterlockedCompareExchange64((volatile LONG64*)atomic, (LONG64)new_value, (LONG64)previous_value);
 #elif defined(COMPILER_GCC)
     static_assert(__atomic_always_lock_free(sizeof(T), NULL));
-    T output;
-    __atomic_compare_exchange(atomic, &new_value, &output, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQ_REL);
-    return output;
+    // NOTE(hugo): /previous_value/ is overwritten with the current value on failure ie the output is the value before the instruction
+    // __ATOMIC_ACQ_REL is invalid for the failure memory order
+    __atomic_compare_exchange(atomic, &previous_value, &new_value, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+    return previous_value;
 #else
     static_assert(false, "atomic_compare_exchange not implemented");
 #endif
@@ -89,6 +90,28 @@ inline void atomic_set(volatile T* atomic, T value){
 #endif
 }
 
+template<typename T>
+inline T atomic_add(volatile T* atomic, T value){
+    static_assert((sizeof(T) == 1u || sizeof(T) == 2u || sizeof(T) == 4u || sizeof(T) == 8u),
+            "atomic_add is not implemented for this type");
+
+#if defined(COMPILER_MSVC)
+    if constexpr (sizeof(T) == 1u)
+        return (T)_InterlockedExchangeAdd8((volatile char*)atomic, (char)value);
+    else if constexpr (sizeof(T) == 2u)
+        return (T)_InterlockedExchangeAdd16((volatile short*)atomic, (short)value);
+    else if constexpr (sizeof(T) == 4u)
+        return (T)_InterlockedExchangeAdd((volatile long*)atomic, (long)value);
+    else if constexpr (sizeof(T) == 8u)
+        return (T)_InterlockedExchangeAdd64((volatile LONG64*)atomic, (LONG64)value);
+#elif defined(COMPILER_GCC)
+    static_assert(__atomic_always_lock_free(sizeof(T), NULL));
+    return __atomic_fetch_add(atomic, value, __ATOMIC_ACQ_REL);
+#else
+    static_assert(false, "atomic_add not implemented");
+#endif
+}
+
 // ---- endianness conversion
 
 template<typename T>
@@ -0,0 +1,145 @@
+namespace BEEWAX_INTERNAL{
+    // NOTE(hugo): the strings are stored contiguously in a Virtual_Arena ie pointers are stable
+    constexpr size_t string_table_max_bytesize = MEGABYTES(256u);
+
+    struct String_Table_Entry{
+        const char* str;
+        size_t strlen;
+    };
+
+    struct String_Table{
+        Virtual_Arena storage;
+        array<String_Table_Entry> entries;
+        hashmap<u64, String_ID> ids;
+    };
+
+    static String_Table string_table = {};
+    static volatile u32 string_table_lock = 0u;
+
+    static void string_table_acquire(){
+        while(atomic_exchange<u32>(&string_table_lock, 1u)){}
+    }
+    static void string_table_release(){
+        atomic_set<u32>(&string_table_lock, 0u);
+    }
+
+    // NOTE(hugo): created on the first use
+    static void string_table_setup(){
+        if(!string_table.storage.vmemory){
+            string_table.storage.create(string_table_max_bytesize);
+            string_table.entries.create();
+            string_table.ids.create();
+        }
+    }
+
+    static bool string_table_entry_equal(String_ID id, const char* str, size_t strlen){
+        const String_Table_Entry& entry = string_table.entries[id];
+        return entry.strlen == strlen && memcmp(entry.str, str, strlen) == 0;
+    }
+
+    // NOTE(hugo): two interned strings with the same 64 bits hash are not supported
+    static void string_table_check_collision(String_ID id, const char* str, size_t strlen){
+        ENGINE_CHECK(string_table_entry_equal(id, str, strlen),
+                "string_id Error: hash collision between %s and %.*s", string_table.entries[id].str, (int)strlen, str);
+    }
+}
+
+String_ID string_id(const char* str){
+    return string_id(str, strlen(str));
+}
+
+String_ID string_id(const char* str, size_t strlen){
+    return string_id(str, strlen, string_id_hash(str, strlen));
+}
+
+String_ID string_id(const char* str, size_t strlen, u64 hash){
+    using namespace BEEWAX_INTERNAL;
+    assert(hash == string_id_hash(str, strlen));
+
+    string_table_acquire();
+    string_table_setup();
+
+    String_ID* id;
+    if(string_table.ids.get(hash, id)){
+        char* storage = (char*)string_table.storage.allocate(strlen + 1u, 1u).ptr;
+        memcpy(storage, str, strlen);
+        storage[strlen] = '\0';
+
+        *id = (String_ID)string_table.entries.size;
+        string_table.entries.push({storage, strlen});
+
+    }else{
+        string_table_check_collision(*id, str, strlen);
+    }
+
+    String_ID output = *id;
+    string_table_release();
+
+    return output;
+}
+
+String_ID search_string_id(const char* str){
+    return search_string_id(str, strlen(str));
+}
+
+String_ID search_string_id(const char* str, size_t strlen){
+    using namespace BEEWAX_INTERNAL;
+    u64 hash = string_id_hash(str, strlen);
+
+    String_ID output = invalid_string_id;
+
+    string_table_acquire();
+    String_ID* id;
+    // NOTE(hugo): a string that was never interned may share the hash of an interned one
+    if(string_table.storage.vmemory && string_table.ids.search(hash, id) && string_table_entry_equal(*id, str, strlen)){
+        output = *id;
+    }
+    string_table_release();
+
+    return output;
+}
+
+const char* string_id_cstring(String_ID id){
+    using namespace BEEWAX_INTERNAL;
+
+    string_table_acquire();
+    assert(id < string_table.entries.size);
+    const char* output = string_table.entries[id].str;
+    string_table_release();
+
+    return output;
+}
+
+size_t string_id_strlen(String_ID id){
+    using namespace BEEWAX_INTERNAL;
+
+    string_table_acquire();
+    assert(id < string_table.entries.size);
+    size_t output = string_table.entries[id].strlen;
+    string_table_release();
+
+    return output;
+}
+
+u32 string_table_size(){
+    using namespace BEEWAX_INTERNAL;
+
+    string_table_acquire();
+    u32 output = (u32)string_table.entries.size;
+    string_table_release();
+
+    return output;
+}
+
+void destroy_string_table(){
+    using namespace BEEWAX_INTERNAL;
+
+    string_table_acquire();
+    if(string_table.storage.vmemory){
+        string_table.ids.destroy();
+        string_table.entries.destroy();
+        string_table.storage.destroy();
+        string_table = {};
+    }
+    string_table_release();
+}
@@ -0,0 +1,50 @@
+#ifndef H_STRING_ID
+#define H_STRING_ID
+
+// REF(hugo): https://web.archive.org/web/20140719100333/http://altdev.co/2011/10/27/quasi-compile-time-string-hashing/
+
+// NOTE(hugo): strings are interned in a global table and identified by a dense u32 ie compared and hashed as an integer
+// ids are attributed in order of first interning starting from 0 and stay valid until destroy_string_table()
+// /!\ ids depend on the interning order /!\ must not be serialized
+
+typedef u32 String_ID;
+constexpr String_ID invalid_string_id = UINT32_MAX;
+
+// NOTE(hugo): FNV1a 64 bits ; constexpr such that the hash of literals is computed at compile time
+constexpr u64 string_id_hash(const char* str, size_t strlen){
+    u64 hash = 14695981039346656037u;
+    for(size_t ichar = 0u; ichar != strlen; ++ichar){
+        hash ^= (u64)(u8)str[ichar];
+        hash *= 1099511628211u;
+    }
+    return hash;
+}
+
+// NOTE(hugo): returns the id of /str/ and interns it when it is not in the table ; thread-safe
+String_ID string_id(const char* str);
+String_ID string_id(const char* str, size_t strlen);
+String_ID string_id(const char* str, size_t strlen, u64 hash);
+
+// NOTE(hugo): returns invalid_string_id when /str/ was never interned
+String_ID search_string_id(const char* str);
+String_ID search_string_id(const char* str, size_t strlen);
+
+// NOTE(hugo): the interned string is null terminated and never moves
+const char* string_id_cstring(String_ID id);
+size_t string_id_strlen(String_ID id);
+
+u32 string_table_size();
+
+// NOTE(hugo): releases the interned strings ie every id is invalidated
+// /!\ STRING_ID() keeps the id of each call site /!\ only call on exit
+void destroy_string_table();
+
+// NOTE(hugo): id of a literal ; the hash is computed at compile time and the table is searched once per call site
+#define STRING_ID(LITERAL)                                                                              \
+[](){                                                                                                   \
+    constexpr u64 string_id_literal_hash = string_id_hash(LITERAL, sizeof(LITERAL) - 1u);               \
+    static const String_ID string_id_literal = string_id(LITERAL, sizeof(LITERAL) - 1u, string_id_literal_hash); \
+    return string_id_literal;                                                                           \
+}()
+
+#endif
@@ -0,0 +1,369 @@
+namespace BEEWAX_INTERNAL{
+    constexpr size_t tlsf_header_bytesize = offsetof(TLSF_Block, next_free);
+    constexpr size_t tlsf_min_block_bytesize = sizeof(TLSF_Block) - tlsf_header_bytesize;
+    constexpr size_t tlsf_max_block_bytesize = (size_t)1u << (tlsf_fl_max_log2 - 1u);
+    constexpr size_t tlsf_free_bit = 1u;
+    static_assert(tlsf_header_bytesize % tlsf_alignment == 0u && tlsf_min_block_bytesize % tlsf_alignment == 0u);
+
+    static inline size_t tlsf_block_size(const TLSF_Block* block){
+        return block->size & ~tlsf_free_bit;
+    }
+
+    static inline bool tlsf_block_is_free(const TLSF_Block* block){
+        return block->size & tlsf_free_bit;
+    }
+
+    static inline TLSF_Block* tlsf_block_next(const TLSF_Block* block){
+        return (TLSF_Block*)((u8*)block + tlsf_header_bytesize + tlsf_block_size(block));
+    }
+
+    static inline size_t tlsf_adjust_bytesize(size_t bytesize){
+        return max(round_up_multiple(bytesize, tlsf_alignment), tlsf_min_block_bytesize);
+    }
+
+    static void tlsf_mapping(size_t size, u32& fl, u32& sl){
+        if(size < ((size_t)1u << tlsf_fl_shift)){
+            fl = 0u;
+            sl = (u32)(size >> tlsf_alignment_log2);
+        }else{
+            u32 msb = 63u - bitscan_ML((u64)size);
+            sl = (u32)(size >> (msb - tlsf_sl_log2)) ^ tlsf_sl_count;
+            fl = msb - tlsf_fl_shift + 1u;
+        }
+    }
+
+    // NOTE(hugo): rounds up to the next list ie every block of the list returned is large enough
+    static void tlsf_mapping_search(size_t size, u32& fl, u32& sl){
+        if(size >= ((size_t)1u << tlsf_fl_shift)){
+            u32 msb = 63u - bitscan_ML((u64)size);
+            size += ((size_t)1u << (msb - tlsf_sl_log2)) - 1u;
+        }
+        tlsf_mapping(size, fl, sl);
+    }
+
+    static void tlsf_insert(TLSF_Allocator& allocator, TLSF_Block* block){
+        u32 fl, sl;
+        tlsf_mapping(tlsf_block_size(block), fl, sl);
+
+        TLSF_Block* head = allocator.free_lists[fl][sl];
+        block->next_free = head;
+        block->prev_free = nullptr;
+        if(head) head->prev_free = block;
+
+        allocator.free_lists[fl][sl] = block;
+        allocator.fl_bitmap |= 1u << fl;
+        allocator.sl_bitmap[fl] |= 1u << sl;
+    }
+
+    static void tlsf_remove(TLSF_Allocator& allocator, TLSF_Block* block){
+        u32 fl, sl;
+        tlsf_mapping(tlsf_block_size(block), fl, sl);
+
+        if(block->next_free) block->next_free->prev_free = block->prev_free;
+        if(block->prev_free) block->prev_free->next_free = block->next_free;
+
+        if(allocator.free_lists[fl][sl] == block){
+            allocator.free_lists[fl][sl] = block->next_free;
+            if(!block->next_free){
+                allocator.sl_bitmap[fl] &= ~(1u << sl);
+                if(!allocator.sl_bitmap[fl]) allocator.fl_bitmap &= ~(1u << fl);
+            }
+        }
+    }
+
+    static TLSF_Block* tlsf_find(TLSF_Allocator& allocator, size_t size){
+        u32 fl, sl;
+        tlsf_mapping_search(size, fl, sl);
+        if(fl >= tlsf_fl_count) return nullptr;
+
+        u32 sl_map = allocator.sl_bitmap[fl] & (~0u << sl);
+        if(!sl_map){
+            u32 fl_map = allocator.fl_bitmap & (~0u << (fl + 1u));
+            if(!fl_map) return nullptr;
+
+            fl = bitscan_LM(fl_map);
+            sl_map = allocator.sl_bitmap[fl];
+        }
+        sl = bitscan_LM(sl_map);
+
+        return allocator.free_lists[fl][sl];
+    }
+
+    // NOTE(hugo): returns the remainder of the block as a free block that is not in the free lists yet
+    static TLSF_Block* tlsf_split(TLSF_Block* block, size_t size){
+        size_t block_size = tlsf_block_size(block);
+        if(block_size < size + tlsf_header_bytesize + tlsf_min_block_bytesize) return nullptr;
+
+        TLSF_Block* remainder = (TLSF_Block*)((u8*)block + tlsf_header_bytesize + size);
+        remainder->prev_physical = block;
+        remainder->size = (block_size - size - tlsf_header_bytesize) | tlsf_free_bit;
+        tlsf_block_next(remainder)->prev_physical = remainder;
+
+        block->size = size | (block->size & tlsf_free_bit);
+
+        return remainder;
+    }
+
+    // NOTE(hugo): coalesces with the free physical neighbours ie two free blocks are never adjacent
+    static void tlsf_merge_insert(TLSF_Allocator& allocator, TLSF_Block* block){
+        TLSF_Block* prev = block->prev_physical;
+        if(prev && tlsf_block_is_free(prev)){
+            tlsf_remove(allocator, prev);
+            prev->size += tlsf_header_bytesize + tlsf_block_size(block);
+            tlsf_block_next(prev)->prev_physical = prev;
+            block = prev;
+        }
+
+        TLSF_Block* next = tlsf_block_next(block);
+        if(tlsf_block_is_free(next)){
+            tlsf_remove(allocator, next);
+            block->size += tlsf_header_bytesize + tlsf_block_size(next);
+            tlsf_block_next(block)->prev_physical = block;
+        }
+
+        tlsf_insert(allocator, block);
+    }
+
+    // NOTE(hugo): the sentinel is a used block of size 0 at the end of the pool ; it becomes the header of the new free block
+    // the block is oversized by 1 / tlsf_sl_count so that tlsf_mapping_search() finds it
+    static bool tlsf_grow(TLSF_Allocator& allocator, size_t size){
+        size_t grow_bytesize = round_up_multiple(size + (size >> tlsf_sl_log2) + 2u * tlsf_header_bytesize, tlsf_grow_bytesize);
+        size_t arena_bytesize = grow_bytesize + (allocator.sentinel ? 0u : tlsf_header_bytesize);
+        if(allocator.arena.cursor + arena_bytesize > allocator.arena.vbytesize) return false;
+
+        Virtual_Arena_Memory memory = allocator.arena.allocate(arena_bytesize, tlsf_alignment);
+
+        TLSF_Block* block = allocator.sentinel;
+        if(!block){
+            block = (TLSF_Block*)memory.ptr;
+            block->prev_physical = nullptr;
+        }
+        block->size = (grow_bytesize - tlsf_header_bytesize) | tlsf_free_bit;
+
+        TLSF_Block* sentinel = tlsf_block_next(block);
+        sentinel->prev_physical = block;
+        sentinel->size = 0u;
+        allocator.sentinel = sentinel;
+
+        tlsf_merge_insert(allocator, block);
+
+        return true;
+    }
+}
+
+void TLSF_Allocator::create(size_t max_bytesize){
+    *this = TLSF_Allocator();
+    arena.create(max_bytesize);
+}
+
+void TLSF_Allocator::destroy(){
+    arena.destroy();
+    *this = TLSF_Allocator();
+}
+
+void* TLSF_Allocator::allocate(size_t bytesize){
+    u64 start = cycle_counter();
+
+    size_t size = BEEWAX_INTERNAL::tlsf_adjust_bytesize(bytesize);
+    if(size >= BEEWAX_INTERNAL::tlsf_max_block_bytesize) return nullptr;
+
+    BEEWAX_INTERNAL::TLSF_Block* block = BEEWAX_INTERNAL::tlsf_find(*this, size);
+    if(!block && BEEWAX_INTERNAL::tlsf_grow(*this, size)) block = BEEWAX_INTERNAL::tlsf_find(*this, size);
+    if(!block) return nullptr;
+
+    BEEWAX_INTERNAL::tlsf_remove(*this, block);
+    block->size &= ~BEEWAX_INTERNAL::tlsf_free_bit;
+
+    // NOTE(hugo): the next physical block is used since free blocks are coalesced
+    BEEWAX_INTERNAL::TLSF_Block* remainder = BEEWAX_INTERNAL::tlsf_split(block, size);
+    if(remainder) BEEWAX_INTERNAL::tlsf_insert(*this, remainder);
+
+    used_bytesize += BEEWAX_INTERNAL::tlsf_block_size(block);
+    ++nused_blocks;
+
+    u64 cycles = cycle_counter() - start;
+    ++nallocations;
+    allocation_cycles += cycles;
+    max_allocation_cycles = max(max_allocation_cycles, cycles);
+
+    return (void*)((u8*)block + BEEWAX_INTERNAL::tlsf_header_bytesize);
+}
+
+void* TLSF_Allocator::reallocate(void* ptr, size_t bytesize){
+    if(!ptr) return allocate(bytesize);
+    if(!bytesize){
+        free(ptr);
+        return nullptr;
+    }
+
+    u64 start = cycle_counter();
+
+    BEEWAX_INTERNAL::TLSF_Block* block = (BEEWAX_INTERNAL::TLSF_Block*)((u8*)ptr - BEEWAX_INTERNAL::tlsf_header_bytesize);
+    assert(!BEEWAX_INTERNAL::tlsf_block_is_free(block));
+
+    size_t size = BEEWAX_INTERNAL::tlsf_adjust_bytesize(bytesize);
+    size_t block_size = BEEWAX_INTERNAL::tlsf_block_size(block);
+
+    // NOTE(hugo): grow in place when the next physical block is free and large enough
+    if(size > block_size){
+        BEEWAX_INTERNAL::TLSF_Block* next = BEEWAX_INTERNAL::tlsf_block_next(block);
+        if(!BEEWAX_INTERNAL::tlsf_block_is_free(next)
+        || block_size + BEEWAX_INTERNAL::tlsf_header_bytesize + BEEWAX_INTERNAL::tlsf_block_size(next) < size){
+            void* output = allocate(bytesize);
+            if(output){
+                memcpy(output, ptr, block_size);
+                free(ptr);
+            }
+            return output;
+        }
+
+        BEEWAX_INTERNAL::tlsf_remove(*this, next);
+        block->size += BEEWAX_INTERNAL::tlsf_header_bytesize + BEEWAX_INTERNAL::tlsf_block_size(next);
+        BEEWAX_INTERNAL::tlsf_block_next(block)->prev_physical = block;
+    }
+
+    // NOTE(hugo): give the tail back
+    BEEWAX_INTERNAL::TLSF_Block* remainder = BEEWAX_INTERNAL::tlsf_split(block, size);
+    if(remainder) BEEWAX_INTERNAL::tlsf_merge_insert(*this, remainder);
+
+    used_bytesize = used_bytesize - block_size + BEEWAX_INTERNAL::tlsf_block_size(block);
+
+    u64 cycles = cycle_counter() - start;
+    ++nallocations;
+    allocation_cycles += cycles;
+    max_allocation_cycles = max(max_allocation_cycles, cycles);
+
+    return ptr;
+}
+
+void TLSF_Allocator::free(void* ptr){
+    if(!ptr) return;
+
+    u64 start = cycle_counter();
+
+    BEEWAX_INTERNAL::TLSF_Block* block = (BEEWAX_INTERNAL::TLSF_Block*)((u8*)ptr - BEEWAX_INTERNAL::tlsf_header_bytesize);
+    assert(!BEEWAX_INTERNAL::tlsf_block_is_free(block));
+
+    used_bytesize -= BEEWAX_INTERNAL::tlsf_block_size(block);
+    --nused_blocks;
+
+    block->size |= BEEWAX_INTERNAL::tlsf_free_bit;
+    BEEWAX_INTERNAL::tlsf_merge_insert(*this, block);
+
+    u64 cycles = cycle_counter() - start;
+    ++nfrees;
+    free_cycles += cycles;
+    max_free_cycles = max(max_free_cycles, cycles);
+}
+
+TLSF_Statistics TLSF_Allocator::statistics() const{
+    TLSF_Statistics output = {};
+    output.pool_bytesize = arena.cursor;
+    output.used_bytesize = used_bytesize;
+    output.nused_blocks = nused_blocks;
+
+    for(u32 fl = 0u; fl != BEEWAX_INTERNAL::tlsf_fl_count; ++fl){
+        for(u32 sl = 0u; sl != BEEWAX_INTERNAL::tlsf_sl_count; ++sl){
+            BEEWAX_INTERNAL::TLSF_Block* block = free_lists[fl][sl];
+            while(block){
+                size_t block_size = BEEWAX_INTERNAL::tlsf_block_size(block);
+                output.free_bytesize += block_size;
+                output.largest_free_bytesize = max(output.largest_free_bytesize, block_size);
+                ++output.nfree_blocks;
+
+                block = block->next_free;
+            }
+        }
+    }
+
+    output.fragmentation = output.free_bytesize ? 1.f - (float)output.largest_free_bytesize / (float)output.free_bytesize : 0.f;
+
+    output.nallocations = nallocations;
+    output.allocation_cycles = allocation_cycles;
+    output.max_allocation_cycles = max_allocation_cycles;
+    output.nfrees = nfrees;
+    output.free_cycles = free_cycles;
+    output.max_free_cycles = max_free_cycles;
+
+    return output;
+}
+
+#if defined(ALLOCATOR_TLSF)
+
+namespace BEEWAX_INTERNAL{
+    static TLSF_Allocator engine_allocator = {};
+    static volatile u32 engine_allocator_lock = 0u;
+
+    // NOTE(hugo): the allocator is created on the first allocation ie may be used before the engine is setup
+    static void engine_allocator_acquire(){
+        while(atomic_exchange<u32>(&engine_allocator_lock, 1u)){}
+
+        if(!engine_allocator.arena.vmemory){
+            if(!vmemory_pagesize) setup_vmemory();
+            engine_allocator.create();
+        }
+    }
+
+    static void engine_allocator_release(){
+        atomic_set<u32>(&engine_allocator_lock, 0u);
+    }
+
+    void* engine_allocator_malloc(size_t bytesize){
+        engine_allocator_acquire();
+        void* output = engine_allocator.allocate(bytesize);
+        engine_allocator_release();
+
+        return output;
+    }
+
+    void* engine_allocator_calloc(size_t count, size_t bytesize){
+        bytesize = bytesize * count;
+
+        void* output = engine_allocator_malloc(bytesize);
+        if(output) memset(output, 0, bytesize);
+
+        return output;
+    }
+
+    void* engine_allocator_realloc(void* ptr, size_t bytesize){
+        engine_allocator_acquire();
+        void* output = engine_allocator.reallocate(ptr, bytesize);
+        engine_allocator_release();
+
+        return output;
+    }
+
+    void engine_allocator_free(void* ptr){
+        if(!ptr) return;
+
+        engine_allocator_acquire();
+        engine_allocator.free(ptr);
+        engine_allocator_release();
+    }
+}
+
+TLSF_Statistics engine_allocator_statistics(){
+    BEEWAX_INTERNAL::engine_allocator_acquire();
+    TLSF_Statistics output = BEEWAX_INTERNAL::engine_allocator.statistics();
+    BEEWAX_INTERNAL::engine_allocator_release();
+
+    return output;
+}
+
+void engine_allocator_summary(){
+    TLSF_Statistics stats = engine_allocator_statistics();
+
+    LOG_RAW("-------- engine_allocator_summary --------");
+    LOG_RAW("pool:          %" PRIu64 " bytes", (u64)stats.pool_bytesize);
+    LOG_RAW("used:          %" PRIu64 " bytes in %" PRIu32 " blocks", (u64)stats.used_bytesize, stats.nused_blocks);
+    LOG_RAW("free:          %" PRIu64 " bytes in %" PRIu32 " blocks", (u64)stats.free_bytesize, stats.nfree_blocks);
+    LOG_RAW("largest free:  %" PRIu64 " bytes", (u64)stats.largest_free_bytesize);
+    LOG_RAW("fragmentation: %f", stats.fragmentation);
+    LOG_RAW("allocate:      %" PRIu64 " calls, %" PRIu64 " cycles average, %" PRIu64 " cycles max",
+            stats.nallocations, stats.nallocations ? stats.allocation_cycles / stats.nallocations : 0u, stats.max_allocation_cycles);
+    LOG_RAW("free:          %" PRIu64 " calls, %" PRIu64 " cycles average, %" PRIu64 " cycles max",
+            stats.nfrees, stats.nfrees ? stats.free_cycles / stats.nfrees : 0u, stats.max_free_cycles);
+    LOG_RAW("------------------------------------------");
+}
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef H_TLSF_ALLOCATOR
+#define H_TLSF_ALLOCATOR
+
+// REF(hugo):
+// http://www.gii.upv.es/tlsf/files/papers/ecrts04_tlsf.pdf
+// https://github.com/mattconte/tlsf
+
+// NOTE(hugo): two-level segregated fit ie O(1) allocate and free using two bitmaps and an array of free lists
+// first level = power of two size class, second level = linear subdivision of the first level
+// blocks are carved out of a Virtual_Arena that grows by tlsf_grow_bytesize ; the pool never shrinks
+// /!\ not thread-safe /!\ the bw_* allocator is protected by a lock cf. tracked_memory.h
+
+constexpr size_t tlsf_alignment = 16u;
+constexpr size_t tlsf_grow_bytesize = MEGABYTES(1u);
+constexpr size_t tlsf_max_bytesize = GIGABYTES(16u);
+
+namespace BEEWAX_INTERNAL{
+    constexpr u32 tlsf_sl_log2 = 5u;
+    constexpr u32 tlsf_sl_count = 1u << tlsf_sl_log2;
+    constexpr u32 tlsf_alignment_log2 = 4u;
+    // NOTE(hugo): blocks below (1 << tlsf_fl_shift) are in the first list, subdivided in tlsf_alignment steps
+    constexpr u32 tlsf_fl_shift = tlsf_sl_log2 + tlsf_alignment_log2;
+    constexpr u32 tlsf_fl_max_log2 = 38u;
+    constexpr u32 tlsf_fl_count = tlsf_fl_max_log2 - tlsf_fl_shift + 1u;
+    static_assert(tlsf_fl_count < 32u);
+    static_assert((1u << tlsf_alignment_log2) == tlsf_alignment);
+
+    // NOTE(hugo): the payload follows the header ; next_free and prev_free are stored in the payload of free blocks
+    struct TLSF_Block{
+        TLSF_Block* prev_physical;
+        size_t size;
+
+        TLSF_Block* next_free;
+        TLSF_Block* prev_free;
+    };
+}
+
+struct TLSF_Statistics{
+    // NOTE(hugo): pool = committed to the allocator, used and free = payload bytesize of the blocks
+    size_t pool_bytesize;
+    size_t used_bytesize;
+    size_t free_bytesize;
+    size_t largest_free_bytesize;
+    u32 nused_blocks;
+    u32 nfree_blocks;
+
+    // NOTE(hugo): 1 - largest_free / free ie 0 when the free memory is a single block
+    float fragmentation;
+
+    // NOTE(hugo): cycle_counter() deltas ; reallocate() counts as an allocation
+    u64 nallocations;
+    u64 allocation_cycles;
+    u64 max_allocation_cycles;
+
+    u64 nfrees;
+    u64 free_cycles;
+    u64 max_free_cycles;
+};
+
+struct TLSF_Allocator{
+    void create(size_t max_bytesize = tlsf_max_bytesize);
+    void destroy();
+
+    // NOTE(hugo): same semantics as malloc, realloc and free ; the memory is aligned on tlsf_alignment
+    void* allocate(size_t bytesize);
+    void* reallocate(void* ptr, size_t bytesize);
+    void free(void* ptr);
+
+    // NOTE(hugo): walks the free lists ie not meant to be called every frame
+    TLSF_Statistics statistics() const;
+
+    // ---- data
+
+    Virtual_Arena arena;
+    BEEWAX_INTERNAL::TLSF_Block* sentinel;
+
+    u32 fl_bitmap;
+    u32 sl_bitmap[BEEWAX_INTERNAL::tlsf_fl_count];
+    BEEWAX_INTERNAL::TLSF_Block* free_lists[BEEWAX_INTERNAL::tlsf_fl_count][BEEWAX_INTERNAL::tlsf_sl_count];
+
+    size_t used_bytesize;
+    u32 nused_blocks;
+
+    u64 nallocations;
+    u64 allocation_cycles;
+    u64 max_allocation_cycles;
+
+    u64 nfrees;
+    u64 free_cycles;
+    u64 max_free_cycles;
+};
+
+#if defined(ALLOCATOR_TLSF)
+// NOTE(hugo): statistics of the allocator behind the bw_* macros
+TLSF_Statistics engine_allocator_statistics();
+void engine_allocator_summary();
+#endif
+
+#endif
@@ -1,138 +1,436 @@
 #if defined(DEVELOPPER_MODE)
 
 namespace BEEWAX_INTERNAL{
-    struct Tracked_Memory{
-        Tracked_Memory* prev;
-        Tracked_Memory* next;
+    // NOTE(hugo): allocations are aggregated per callsite ie (filename, function, line) in a lock-free open addressing table
+    // callsites are identified by the address of the literals and never removed
+    // /!\ callsites above memtracker_max_callsites / 2 are aggregated in the overflow callsite /!\ ie index 0
+    constexpr u32 memtracker_max_callsites = 4096u;
+    static_assert((memtracker_max_callsites & (memtracker_max_callsites - 1u)) == 0u);
 
+    struct Memtracker_Header{
+        u64 bytesize;
+        u16 callsite;
+        // NOTE(hugo): trace_id is 0u when the allocation was made outside of a trace ; ids restart from 1u with every trace
+        u16 trace_index;
+        u32 trace_id;
+    };
+    static_assert(sizeof(Memtracker_Header) == 16u);
+    static_assert(memtracker_max_callsites <= UINT16_MAX + 1u);
+
+    struct Memtracker_Counters{
+        volatile s64 live_bytesize;
+        volatile s64 peak_bytesize;
+        volatile s64 live_count;
+
+        volatile u64 nallocations;
+        volatile u64 nreallocations;
+        volatile u64 realloc_bytesize;
+
+        volatile u64 frame_allocations;
+        volatile u64 last_frame_allocations;
+        volatile u64 peak_frame_allocations;
+    };
+
+    constexpr u32 memtracker_callsite_empty = 0u;
+    constexpr u32 memtracker_callsite_writing = 1u;
+    constexpr u32 memtracker_callsite_ready = 2u;
+
+    struct Memtracker_Callsite{
+        volatile u32 state;
+        u32 line;
         const char* filename;
         const char* function;
-        u64 line;
-        u64 bytesize;
+
+        Memtracker_Counters counters;
     };
-    static_assert(sizeof(Tracked_Memory) == 48u);
 
-    static Tracked_Memory memtracker_head = {nullptr, nullptr, nullptr, nullptr, 0u, 0u};
+    static Memtracker_Callsite memtracker_callsites[memtracker_max_callsites] = {{memtracker_callsite_ready, 0u, "overflow", "overflow", {}}};
+    static Memtracker_Counters memtracker_total = {};
 
-    void* memtracker_malloc(size_t bytesize, const char* filename, const char* function, const u32 line){
-        size_t memtracker_bytesize = bytesize + sizeof(Tracked_Memory);
+    // NOTE(hugo): indices of the claimed callsites in claim order ; 0u until the claiming thread writes it
+    static volatile u32 memtracker_claimed[memtracker_max_callsites] = {};
+    static volatile u32 memtracker_nclaimed = 0u;
+
+    // ---- trace
+
+    constexpr u32 memtrace_buffer_size = 4096u;
 
-        Tracked_Memory* header = (Tracked_Memory*)::malloc(memtracker_bytesize);
-        if(header){
-            header->prev = &memtracker_head;
-            header->next = memtracker_head.next;
+    static volatile u32 memtrace_active = 0u;
+    static volatile u32 memtrace_lock = 0u;
+    static volatile u32 memtrace_next_id = 1u;
+    static volatile u32 memtrace_index = 0u;
+    static volatile u32 memtrace_nthreads = 0u;
+    static thread_local u32 memtrace_thread = 0u;
 
-            memtracker_head.next = header;
-            if(header->next) header->next->prev = header;
+    static FILE* memtrace_file = nullptr;
+    static u64 memtrace_nevents = 0u;
+    static u64 memtrace_start_ticks = 0u;
+    static u32 memtrace_nbuffered = 0u;
+    static Memtrace_Event memtrace_buffer[memtrace_buffer_size];
 
-            header->filename = filename;
-            header->function = function;
-            header->bytesize = bytesize;
-            header->line = line;
+    static void memtrace_flush(){
+        fwrite(memtrace_buffer, sizeof(Memtrace_Event), memtrace_nbuffered, memtrace_file);
+        memtrace_nbuffered = 0u;
+    }
+
+    static void memtrace_allocation_id(Memtracker_Header* header){
+        header->trace_index = (u16)atomic_get<u32>(&memtrace_index);
+        header->trace_id = atomic_get<u32>(&memtrace_active) ? atomic_add<u32>(&memtrace_next_id, 1u) : 0u;
+    }
+
+    // NOTE(hugo): false for the allocations made outside of the current trace ie their id is meaningless in this trace
+    static bool memtrace_current(u32 trace_id, u16 trace_index){
+        return trace_id && trace_index == (u16)atomic_get<u32>(&memtrace_index) && atomic_get<u32>(&memtrace_active);
+    }
+
+    // NOTE(hugo): the event is buffered under the lock before the allocation function returns
+    // ie the events of an allocation are always recorded after its creation even when released by another thread
+    static void memtrace_record(Memtrace_Event_Type type, u32 id, u64 bytesize, u32 callsite){
+        if(!memtrace_thread) memtrace_thread = atomic_add<u32>(&memtrace_nthreads, 1u) + 1u;
+
+        while(atomic_exchange<u32>(&memtrace_lock, 1u)){}
 
-            header = header + 1u;
+        if(memtrace_file){
+            Memtrace_Event& event = memtrace_buffer[memtrace_nbuffered++];
+            event.timestamp = timer_ticks() - memtrace_start_ticks;
+            event.bytesize = bytesize;
+            event.id = id;
+            event.callsite = (u16)callsite;
+            event.thread = (u8)(memtrace_thread - 1u);
+            event.type = type;
+
+            ++memtrace_nevents;
+            if(memtrace_nbuffered == memtrace_buffer_size) memtrace_flush();
         }
 
-        return (void*)(header);
+        atomic_set<u32>(&memtrace_lock, 0u);
     }
 
-    void* memtracker_calloc(size_t count, size_t bytesize, const char* filename, const char* function, const u32 line){
-        bytesize = bytesize * count;
-        size_t memtracker_bytesize = bytesize + sizeof(Tracked_Memory);
+    // ----
+
+    static u32 memtracker_callsite(const char* filename, const char* function, const u32 line){
+        u64 key = (u64)(uintptr_t)filename ^ ((u64)(uintptr_t)function << 1u) ^ ((u64)line << 48u);
+        u32 index = (u32)hash_xorshift(key) & (memtracker_max_callsites - 1u);
+
+        while(true){
+            if(index == 0u) index = 1u;
+            Memtracker_Callsite& callsite = memtracker_callsites[index];
+
+            // NOTE(hugo): the slot is checked again when another thread is writing or claimed it first
+            u32 state = atomic_get<u32>(&callsite.state);
+            if(state == memtracker_callsite_ready){
+                if(callsite.line == line && callsite.function == function && callsite.filename == filename) return index;
+                index = (index + 1u) & (memtracker_max_callsites - 1u);
 
-        Tracked_Memory* header = (Tracked_Memory*)::calloc(1u, memtracker_bytesize);
-        if(header){
-            header->prev = &memtracker_head;
-            header->next = memtracker_head.next;
+            }else if(state == memtracker_callsite_empty){
+                if(atomic_get<u32>(&memtracker_nclaimed) >= memtracker_max_callsites / 2u) return 0u;
 
-            memtracker_head.next = header;
-            if(header->next) header->next->prev = header;
+                if(atomic_compare_exchange<u32>(&callsite.state, memtracker_callsite_writing, memtracker_callsite_empty) == memtracker_callsite_empty){
+                    callsite.line = line;
+                    callsite.filename = filename;
+                    callsite.function = function;
+                    atomic_set<u32>(&callsite.state, memtracker_callsite_ready);
 
-            header->filename = filename;
-            header->function = function;
-            header->bytesize = bytesize;
-            header->line = line;
+                    u32 iclaimed = atomic_add<u32>(&memtracker_nclaimed, 1u);
+                    if(iclaimed < memtracker_max_callsites) atomic_set<u32>(&memtracker_claimed[iclaimed], index);
 
-            header = header + 1u;
+                    return index;
+                }
+            }
+        }
+    }
+
+    static void memtracker_update_peak(volatile s64* peak, s64 value){
+        s64 current = atomic_get<s64>(peak);
+        while(value > current){
+            s64 previous = atomic_compare_exchange<s64>(peak, value, current);
+            if(previous == current) break;
+            current = previous;
+        }
+    }
+
+    static void memtracker_add(Memtracker_Counters& counters, u64 bytesize){
+        s64 live = atomic_add<s64>(&counters.live_bytesize, (s64)bytesize) + (s64)bytesize;
+        memtracker_update_peak(&counters.peak_bytesize, live);
+        atomic_add<s64>(&counters.live_count, 1);
+        atomic_add<u64>(&counters.frame_allocations, 1u);
+    }
+
+    static void memtracker_remove(Memtracker_Counters& counters, u64 bytesize){
+        atomic_add<s64>(&counters.live_bytesize, - (s64)bytesize);
+        atomic_add<s64>(&counters.live_count, -1);
+    }
+
+    static void memtracker_record_allocation(u32 icallsite, u64 bytesize){
+        Memtracker_Counters& counters = memtracker_callsites[icallsite].counters;
+
+        memtracker_add(counters, bytesize);
+        memtracker_add(memtracker_total, bytesize);
+        atomic_add<u64>(&counters.nallocations, 1u);
+        atomic_add<u64>(&memtracker_total.nallocations, 1u);
+    }
+
+    static void memtracker_record_release(u32 icallsite, u64 bytesize){
+        memtracker_remove(memtracker_callsites[icallsite].counters, bytesize);
+        memtracker_remove(memtracker_total, bytesize);
+    }
+
+    static Memtracker_Statistics memtracker_snapshot(const Memtracker_Counters& counters){
+        Memtracker_Statistics output;
+        output.live_bytesize = counters.live_bytesize;
+        output.peak_bytesize = counters.peak_bytesize;
+        output.live_count = counters.live_count;
+        output.nallocations = counters.nallocations;
+        output.nreallocations = counters.nreallocations;
+        output.realloc_bytesize = counters.realloc_bytesize;
+        output.last_frame_allocations = counters.last_frame_allocations;
+        output.peak_frame_allocations = counters.peak_frame_allocations;
+        return output;
+    }
+
+    static void memtracker_end_frame(Memtracker_Counters& counters){
+        u64 frame_allocations = atomic_exchange<u64>(&counters.frame_allocations, 0u);
+        counters.last_frame_allocations = frame_allocations;
+        counters.peak_frame_allocations = max((u64)counters.peak_frame_allocations, frame_allocations);
+    }
+
+    // NOTE(hugo): calls function(callsite) for the overflow callsite and every published callsite
+    template<typename F>
+    static void memtracker_for_each_callsite(F&& function){
+        function(memtracker_callsites[0u]);
+
+        u32 nclaimed = min(atomic_get<u32>(&memtracker_nclaimed), memtracker_max_callsites);
+        for(u32 iclaimed = 0u; iclaimed != nclaimed; ++iclaimed){
+            u32 index = atomic_get<u32>(&memtracker_claimed[iclaimed]);
+            if(index) function(memtracker_callsites[index]);
         }
+    }
+
+    static const char* memtracker_basename(const char* filename){
+        const char* slash = strrchr(filename, '/');
+        const char* backslash = strrchr(filename, '\\');
+        const char* separator = slash > backslash ? slash : backslash;
+        return separator ? separator + 1u : filename;
+    }
+
+    struct Memtracker_Entry{
+        const Memtracker_Callsite* callsite;
+        Memtracker_Statistics statistics;
+    };
 
-        return (void*)(header);
+    // NOTE(hugo): decreasing live bytesize then decreasing peak bytesize
+    static s32 memtracker_entry_order(const Memtracker_Entry& A, const Memtracker_Entry& B){
+        s32 live_order = comparison_decreasing_order(A.statistics.live_bytesize, B.statistics.live_bytesize);
+        if(live_order) return live_order;
+        return comparison_decreasing_order(A.statistics.peak_bytesize, B.statistics.peak_bytesize);
+    }
+
+    void* memtracker_malloc(size_t bytesize, const char* filename, const char* function, const u32 line){
+        Memtracker_Header* header = (Memtracker_Header*)BEEWAX_MALLOC(bytesize + sizeof(Memtracker_Header));
+        if(!header) return nullptr;
+
+        header->bytesize = bytesize;
+        header->callsite = (u16)memtracker_callsite(filename, function, line);
+        memtrace_allocation_id(header);
+        memtracker_record_allocation(header->callsite, bytesize);
+
+        if(header->trace_id) memtrace_record(Memtrace_Event_Type::Allocate, header->trace_id, bytesize, header->callsite);
+
+        return (void*)(header + 1u);
+    }
+
+    void* memtracker_calloc(size_t count, size_t bytesize, const char* filename, const char* function, const u32 line){
+        bytesize = bytesize * count;
+
+        Memtracker_Header* header = (Memtracker_Header*)BEEWAX_CALLOC(1u, bytesize + sizeof(Memtracker_Header));
+        if(!header) return nullptr;
+
+        header->bytesize = bytesize;
+        header->callsite = (u16)memtracker_callsite(filename, function, line);
+        memtrace_allocation_id(header);
+        memtracker_record_allocation(header->callsite, bytesize);
+
+        if(header->trace_id) memtrace_record(Memtrace_Event_Type::Callocate, header->trace_id, bytesize, header->callsite);
+
+        return (void*)(header + 1u);
     }
 
     void* memtracker_realloc(void* ptr, size_t bytesize, const char* filename, const char* function, const u32 line){
-        size_t memtracker_bytesize = bytesize + sizeof(Tracked_Memory);
+        if(!ptr) return memtracker_malloc(bytesize, filename, function, line);
 
-        Tracked_Memory* header;
-        if(ptr) header = (Tracked_Memory*)::realloc((void*)((Tracked_Memory*)ptr - 1u), memtracker_bytesize);
-        else    header = (Tracked_Memory*)::realloc(nullptr, memtracker_bytesize);
+        Memtracker_Header* previous_header = (Memtracker_Header*)ptr - 1u;
+        u64 previous_bytesize = previous_header->bytesize;
+        u32 previous_callsite = previous_header->callsite;
+        u32 previous_trace_id = previous_header->trace_id;
+        u16 previous_trace_index = previous_header->trace_index;
 
-        if(header){
-            if(!ptr){
-                header->prev = &memtracker_head;
-                header->next = memtracker_head.next;
-            }
-            header->prev->next = header;
-            if(header->next) header->next->prev = header;
+        Memtracker_Header* header = (Memtracker_Header*)BEEWAX_REALLOC((void*)previous_header, bytesize + sizeof(Memtracker_Header));
+        if(!header) return nullptr;
 
+        memtracker_record_release(previous_callsite, previous_bytesize);
 
-            header->filename = filename;
-            header->function = function;
-            header->bytesize = bytesize;
-            header->line = line;
+        header->bytesize = bytesize;
+        header->callsite = (u16)memtracker_callsite(filename, function, line);
 
-            header = header + 1u;
+        Memtracker_Counters& counters = memtracker_callsites[header->callsite].counters;
+        memtracker_add(counters, bytesize);
+        memtracker_add(memtracker_total, bytesize);
+        atomic_add<u64>(&counters.nreallocations, 1u);
+        atomic_add<u64>(&memtracker_total.nreallocations, 1u);
+
+        // NOTE(hugo): only compares the addresses ie the previous header is not dereferenced
+        if(header != previous_header){
+            u64 copied_bytesize = min(previous_bytesize, (u64)bytesize);
+            atomic_add<u64>(&counters.realloc_bytesize, copied_bytesize);
+            atomic_add<u64>(&memtracker_total.realloc_bytesize, copied_bytesize);
         }
 
-        return (void*)(header);
+        // NOTE(hugo): allocations made before the trace or during a previous trace appear as new allocations
+        header->trace_id = previous_trace_id;
+        header->trace_index = previous_trace_index;
+        if(memtrace_current(previous_trace_id, previous_trace_index)){
+            memtrace_record(Memtrace_Event_Type::Reallocate, previous_trace_id, bytesize, header->callsite);
+        }else if(atomic_get<u32>(&memtrace_active)){
+            memtrace_allocation_id(header);
+            if(header->trace_id) memtrace_record(Memtrace_Event_Type::Allocate, header->trace_id, bytesize, header->callsite);
+        }
+
+        return (void*)(header + 1u);
     }
 
     void memtracker_free(void* ptr){
-        Tracked_Memory* header = (Tracked_Memory*)ptr;
-        if(header){
-            header = header - 1u;
+        if(!ptr) return;
 
-            header->prev->next = header->next;
-            if(header->next)    header->next->prev = header->prev;
-        }
+        Memtracker_Header* header = (Memtracker_Header*)ptr - 1u;
+        memtracker_record_release(header->callsite, header->bytesize);
+
+        if(memtrace_current(header->trace_id, header->trace_index)) memtrace_record(Memtrace_Event_Type::Free, header->trace_id, 0u, header->callsite);
 
-        ::free(header);
+        BEEWAX_FREE(header);
+    }
+
+    Memtracker_Statistics memtracker_statistics(){
+        return memtracker_snapshot(memtracker_total);
+    }
+
+    // NOTE(hugo): the allocations of the other threads during the call are attributed to either frame
+    void memtracker_new_frame(){
+        memtracker_end_frame(memtracker_total);
+        memtracker_for_each_callsite([](Memtracker_Callsite& callsite){
+            memtracker_end_frame(callsite.counters);
+        });
     }
 
     void memtracker_summary(){
+        Memtracker_Entry* entries = (Memtracker_Entry*)BEEWAX_MALLOC(sizeof(Memtracker_Entry) * (memtracker_max_callsites + 1u));
+        u32 nentries = 0u;
+
+        memtracker_for_each_callsite([&](Memtracker_Callsite& callsite){
+            Memtracker_Statistics statistics = memtracker_snapshot(callsite.counters);
+            if(statistics.nallocations || statistics.nreallocations){
+                entries[nentries].callsite = &callsite;
+                entries[nentries].statistics = statistics;
+                ++nentries;
+            }
+        });
+
+        qsort<Memtracker_Entry, &memtracker_entry_order>(entries, nentries);
+
+        Memtracker_Statistics total = memtracker_snapshot(memtracker_total);
+
         LOG_RAW("-------- memtracker_summary --------");
-        LOG_RAW("HEAD:     %p", &memtracker_head);
-        LOG_RAW("next:     %p", memtracker_head.next);
-
-        Tracked_Memory* ptr = memtracker_head.next;
-        while(ptr){
-            LOG_RAW("-- Tracked_Memory --");
-            LOG_RAW("header:   %p", ptr);
-            LOG_RAW("data:     %p", (Tracked_Memory*)ptr + 1u);
-            LOG_RAW("prev:     %p", ptr->prev);
-            LOG_RAW("next:     %p", ptr->next);
-            LOG_RAW("filename: %s", ptr->filename);
-            LOG_RAW("function: %s", ptr->function);
-            LOG_RAW("line:     %d", ptr->line);
-            LOG_RAW("bytesize: %p", ptr->bytesize);
-            LOG_RAW("--");
-
-
-            ptr = ptr->next;
+        LOG_RAW("live: %" PRId64 " bytes in %" PRId64 " allocations - peak: %" PRId64 " bytes - allocations: %" PRIu64
+                " - reallocations: %" PRIu64 " copying %" PRIu64 " bytes - last frame: %" PRIu64 " allocations - peak frame: %" PRIu64 " allocations",
+                total.live_bytesize, total.live_count, total.peak_bytesize, total.nallocations,
+                total.nreallocations, total.realloc_bytesize, total.last_frame_allocations, total.peak_frame_allocations);
+        LOG_RAW("%14s %10s %14s %10s %10s %14s %10s %10s  %s",
+                "live", "count", "peak", "allocs", "reallocs", "realloc copy", "frame", "max frame", "callsite");
+
+        for(u32 ientry = 0u; ientry != nentries; ++ientry){
+            const Memtracker_Callsite* callsite = entries[ientry].callsite;
+            const Memtracker_Statistics& statistics = entries[ientry].statistics;
+
+            LOG_RAW("%14" PRId64 " %10" PRId64 " %14" PRId64 " %10" PRIu64 " %10" PRIu64 " %14" PRIu64 " %10" PRIu64 " %10" PRIu64 "  %s:%" PRIu32 " %s",
+                    statistics.live_bytesize, statistics.live_count, statistics.peak_bytesize,
+                    statistics.nallocations, statistics.nreallocations, statistics.realloc_bytesize,
+                    statistics.last_frame_allocations, statistics.peak_frame_allocations,
+                    memtracker_basename(callsite->filename), callsite->line, callsite->function);
         }
+
         LOG_RAW("------------------------------------");
+
+        BEEWAX_FREE(entries);
     }
 
     void memtracker_leakcheck(){
         LOG_RAW("-------- memtracker_leakcheck --------");
 
-        Tracked_Memory* ptr = memtracker_head.next;
-        while(ptr){
-            LOG_RAW("LEAK!\nFILENAME: %s\nFUNCTION: %s\nLINE: %" PRId64 "\nBYTESIZE: %" PRId64, ptr->filename, ptr->function, ptr->line, ptr->bytesize);
-            ptr = ptr->next;
-        }
+        memtracker_for_each_callsite([](Memtracker_Callsite& callsite){
+            if(callsite.counters.live_count){
+                LOG_RAW("LEAK!\nFILENAME: %s\nFUNCTION: %s\nLINE: %" PRIu32 "\nBYTESIZE: %" PRId64 "\nCOUNT: %" PRId64,
+                        memtracker_basename(callsite.filename), callsite.function, callsite.line,
+                        (s64)callsite.counters.live_bytesize, (s64)callsite.counters.live_count);
+            }
+        });
 
         LOG_RAW("--------------------------------------");
     }
+
+    bool memtracker_trace_start(const char* filename){
+        memtracker_trace_stop();
+
+        FILE* file = fopen(filename, "wb");
+        if(!file){
+            LOG_ERROR("FAILED to open the trace file %s", filename);
+            return false;
+        }
+
+        // NOTE(hugo): placeholder header written again by memtracker_trace_stop()
+        Memtrace_Header header = {};
+        fwrite(&header, sizeof(Memtrace_Header), 1u, file);
+
+        while(atomic_exchange<u32>(&memtrace_lock, 1u)){}
+
+        memtrace_file = file;
+        memtrace_nevents = 0u;
+        memtrace_nbuffered = 0u;
+        memtrace_start_ticks = timer_ticks();
+
+        // NOTE(hugo): the ids of a trace are dense ; the allocations of the previous traces are told apart by their trace_index
+        atomic_set<u32>(&memtrace_next_id, 1u);
+        atomic_add<u32>(&memtrace_index, 1u);
+
+        atomic_set<u32>(&memtrace_lock, 0u);
+        atomic_set<u32>(&memtrace_active, 1u);
+
+        return true;
+    }
+
+    void memtracker_trace_stop(){
+        atomic_set<u32>(&memtrace_active, 0u);
+
+        while(atomic_exchange<u32>(&memtrace_lock, 1u)){}
+
+        if(memtrace_file){
+            memtrace_flush();
+
+            Memtrace_Header header;
+            header.magic = memtrace_magic;
+            header.version = memtrace_version;
+            header.nevents = memtrace_nevents;
+            header.timer_frequency = timer_frequency();
+            header.nids = atomic_get<u32>(&memtrace_next_id);
+            header.padding = 0u;
+
+            fseek(memtrace_file, 0, SEEK_SET);
+            fwrite(&header, sizeof(Memtrace_Header), 1u, memtrace_file);
+            fclose(memtrace_file);
+
+            memtrace_file = nullptr;
+        }
+
+        atomic_set<u32>(&memtrace_lock, 0u);
+    }
 }
 
 #endif
@@ -1,40 +1,133 @@
 #ifndef H_TRACKED_MEMORY
 #define H_TRACKED_MEMORY
 
-// NOTE(hugo): macro required for FILENAME, __func__ and __LINE__
+// NOTE(hugo): macro required for __FILE__, __func__ and __LINE__
+
+// NOTE(hugo): ALLOCATOR_TLSF selects the engine allocator (cf. tlsf_allocator.h) instead of the C runtime
+// /!\ memory allocated with bw_* must be released with bw_* and not with ::free
+
+#if defined(ALLOCATOR_TLSF)
+
+    #define BEEWAX_MALLOC(bytesize)             BEEWAX_INTERNAL::engine_allocator_malloc(bytesize)
+    #define BEEWAX_CALLOC(count, bytesize)      BEEWAX_INTERNAL::engine_allocator_calloc(count, bytesize)
+    #define BEEWAX_REALLOC(pointer, bytesize)   BEEWAX_INTERNAL::engine_allocator_realloc(pointer, bytesize)
+    #define BEEWAX_FREE(ptr)                    BEEWAX_INTERNAL::engine_allocator_free(ptr)
+
+    namespace BEEWAX_INTERNAL{
+        void* engine_allocator_malloc(size_t bytesize);
+        void* engine_allocator_calloc(size_t count, size_t bytesize);
+        void* engine_allocator_realloc(void* ptr, size_t bytesize);
+        void engine_allocator_free(void* ptr);
+    }
+
+#else
+
+    #define BEEWAX_MALLOC(bytesize)             ::malloc(bytesize)
+    #define BEEWAX_CALLOC(count, bytesize)      ::calloc(count, bytesize)
+    #define BEEWAX_REALLOC(pointer, bytesize)   ::realloc(pointer, bytesize)
+    #define BEEWAX_FREE(ptr)                    ::free(ptr)
+
+#endif
 
 #if defined(DEVELOPPER_MODE)
 
-    #define bw_malloc(bytesize)             BEEWAX_INTERNAL::memtracker_malloc(bytesize, FILENAME, __func__, __LINE__)
-    #define bw_calloc(count, bytesize)      BEEWAX_INTERNAL::memtracker_calloc(count, bytesize, FILENAME, __func__, __LINE__)
-    #define bw_realloc(pointer, bytesize)   BEEWAX_INTERNAL::memtracker_realloc(pointer, bytesize, FILENAME, __func__, __LINE__)
+    #define bw_malloc(bytesize)             BEEWAX_INTERNAL::memtracker_malloc(bytesize, __FILE__, __func__, __LINE__)
+    #define bw_calloc(count, bytesize)      BEEWAX_INTERNAL::memtracker_calloc(count, bytesize, __FILE__, __func__, __LINE__)
+    #define bw_realloc(pointer, bytesize)   BEEWAX_INTERNAL::memtracker_realloc(pointer, bytesize, __FILE__, __func__, __LINE__)
     #define bw_free(ptr)                    BEEWAX_INTERNAL::memtracker_free(ptr)
 
     #define DEV_Memtracker_Summary()        BEEWAX_INTERNAL::memtracker_summary()
     #define DEV_Memtracker_Leakcheck()      BEEWAX_INTERNAL::memtracker_leakcheck()
+    #define DEV_Memtracker_New_Frame()      BEEWAX_INTERNAL::memtracker_new_frame()
+
+    #define DEV_Memtracker_Trace_Start(filename)    BEEWAX_INTERNAL::memtracker_trace_start(filename)
+    #define DEV_Memtracker_Trace_Stop()             BEEWAX_INTERNAL::memtracker_trace_stop()
 
     namespace BEEWAX_INTERNAL{
+        // NOTE(hugo): reallocations count as one allocation of the new bytesize and one release of the previous one
+        // realloc_bytesize is the bytesize copied by the reallocations that moved the memory
+        struct Memtracker_Statistics{
+            s64 live_bytesize;
+            s64 peak_bytesize;
+            s64 live_count;
+
+            u64 nallocations;
+            u64 nreallocations;
+            u64 realloc_bytesize;
+
+            u64 last_frame_allocations;
+            u64 peak_frame_allocations;
+        };
+
         void* memtracker_malloc(size_t bytesize, const char* filename, const char* function, const u32 line);
         void* memtracker_calloc(size_t count, size_t bytesize, const char* filename, const char* function, const u32 line);
         void* memtracker_realloc(void* ptr, size_t bytesize, const char* filename, const char* function, const u32 line);
         void memtracker_free(void* ptr);
 
+        // NOTE(hugo): sums every callsite
+        Memtracker_Statistics memtracker_statistics();
+
+        void memtracker_new_frame();
         void memtracker_summary();
         void memtracker_leakcheck();
+
+        // NOTE(hugo): returns false when the file can not be opened
+        bool memtracker_trace_start(const char* filename);
+        void memtracker_trace_stop();
     }
 
 #else
 
-    #define bw_malloc(bytesize)             ::malloc(bytesize)
-    #define bw_calloc(count, bytesize)      ::calloc(count, bytesize)
-    #define bw_realloc(pointer, bytesize)   ::realloc(pointer, bytesize)
-    #define bw_free(ptr)                    ::free(ptr)
+    #define bw_malloc(bytesize)             BEEWAX_MALLOC(bytesize)
+    #define bw_calloc(count, bytesize)      BEEWAX_CALLOC(count, bytesize)
+    #define bw_realloc(pointer, bytesize)   BEEWAX_REALLOC(pointer, bytesize)
+    #define bw_free(ptr)                    BEEWAX_FREE(ptr)
 
     #define DEV_Memtracker_Summary()
     #define DEV_Memtracker_Leakcheck()
+    #define DEV_Memtracker_New_Frame()
+
+    #define DEV_Memtracker_Trace_Start(filename)
+    #define DEV_Memtracker_Trace_Stop()
 
 #endif
 
+// ---- allocation trace
+
+// NOTE(hugo): the bw_* events recorded between DEV_Memtracker_Trace_Start() and DEV_Memtracker_Trace_Stop() ; replayed by application/replay
+// file = Memtrace_Header followed by Memtrace_Event[nevents] in the order of the calls
+// allocations are identified by a dense id in [1, nids[ that is kept by reallocations
+
+constexpr u32 memtrace_magic = 0x4543544Du;
+constexpr u32 memtrace_version = 1u;
+
+enum struct Memtrace_Event_Type : u8{
+    Allocate,
+    Callocate,
+    Reallocate,
+    Free,
+};
+
+struct Memtrace_Header{
+    u32 magic;
+    u32 version;
+    u64 nevents;
+    u64 timer_frequency;
+    u32 nids;
+    u32 padding;
+};
+
+struct Memtrace_Event{
+    // NOTE(hugo): timer_ticks() since the start of the trace ; bytesize is 0u for frees
+    u64 timestamp;
+    u64 bytesize;
+    u32 id;
+    u16 callsite;
+    u8 thread;
+    Memtrace_Event_Type type;
+};
+static_assert(sizeof(Memtrace_Event) == 24u);
+
 
 namespace BEEWAX_INTERNAL{
     template<typename T>
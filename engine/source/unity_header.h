@@ -71,6 +71,8 @@
     #include <sys/mman.h>   // NOTE(hugo): os.h / os.cpp
     #include <unistd.h>     // NOTE(hugo): intrinsics.h
     #include <signal.h>     // NOTE(hugo): debug_break.h
+    #include <sys/stat.h>   // NOTE(hugo): file.cpp
+    #include <fcntl.h>      // NOTE(hugo): file.cpp
 #endif
 
 // ---- compiler includes
@@ -154,12 +156,14 @@ namespace bw{
     #include "utils.h"
     #include "hash.h"
     #include "vmemory.h"
+    #include "tlsf_allocator.h"
 
     #include "data_structure.h"
     #include "dense_grid.h"
     #include "algorithm.h"
 
     #include "sstring.h"
+    #include "string_id.h"
     #include "filepath.h"
     #include "file.h"
 
@@ -196,6 +200,9 @@ namespace bw{
     #include "audio_SDL.h"
     typedef Audio_Player_SDL Audio_Player;
 
+    #include "worker_pool_SDL.h"
+    typedef Worker_Pool_SDL Worker_Pool;
+
     #if defined(RENDERER_OPENGL3)
         #include "GL.h"
 
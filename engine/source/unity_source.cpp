@@ -8,7 +8,9 @@ namespace bw{
     #include "utils.cpp"
     #include "hash.cpp"
     #include "vmemory.cpp"
+    #include "tlsf_allocator.cpp"
 
+    #include "string_id.cpp"
     #include "filepath.cpp"
     #include "file.cpp"
 
@@ -38,6 +40,8 @@ namespace bw{
 
     #include "audio_SDL.cpp"
 
+    #include "worker_pool_SDL.cpp"
+
     #if defined(RENDERER_OPENGL3)
         #include "GL.cpp"
 
@@ -1,20 +1,84 @@
 namespace BEEWAX_INTERNAL{
     static size_t vmemory_pagesize = 0u;
+    static thread_local Virtual_Arena scratch_arena = {nullptr, 0u, 0u, 0u, {}};
 }
 
 void setup_vmemory(){
     BEEWAX_INTERNAL::vmemory_pagesize = detect_pagesize();
 }
 
-void Virtual_Arena::create(size_t bytesize){
+namespace BEEWAX_INTERNAL{
+    // NOTE(hugo): /ptr/ and /bytesize/ are multiples of the page size
+    static void vmemory_commit(void* ptr, size_t bytesize){
+#if defined(PLATFORM_LINUX)
+        ENGINE_CHECK(mprotect(ptr, bytesize, PROT_READ | PROT_WRITE) == 0, "FAILED mprotect");
+#elif defined(PLATFORM_WINDOWS)
+        ENGINE_CHECK(VirtualAlloc(ptr, bytesize, MEM_COMMIT, PAGE_READWRITE), "FAILED VirtualAlloc");
+#else
+        static_assert(false, "vmemory_commit() not implemented for this platform");
+#endif
+    }
+
+    // NOTE(hugo): returns the pages to the OS and makes them inaccessible
+    static void vmemory_decommit(void* ptr, size_t bytesize, bool lazy){
+#if defined(PLATFORM_LINUX)
+        // NOTE(hugo): mprotect alone keeps the physical pages resident
+    #if defined(MADV_FREE)
+        int advice = lazy ? MADV_FREE : MADV_DONTNEED;
+    #else
+        int advice = MADV_DONTNEED;
+    #endif
+        ENGINE_CHECK(madvise(ptr, bytesize, advice) == 0, "FAILED madvise");
+        ENGINE_CHECK(mprotect(ptr, bytesize, PROT_NONE) == 0, "FAILED mprotect");
+#elif defined(PLATFORM_WINDOWS)
+        ENGINE_CHECK(VirtualFree(ptr, bytesize, MEM_DECOMMIT), "FAILED VirtualFree");
+#else
+        static_assert(false, "vmemory_decommit() not implemented for this platform");
+#endif
+    }
+
+    // NOTE(hugo): decommits the pages after /page_index/
+    static void virtual_arena_decommit(Virtual_Arena& arena, size_t page_index){
+        if(page_index >= arena.commit_page_count) return;
+
+        void* base_vmemory = (void*)((u8*)arena.vmemory + page_index * vmemory_pagesize);
+        size_t to_decommit = (arena.commit_page_count - page_index) * vmemory_pagesize;
+        vmemory_decommit(base_vmemory, to_decommit, arena.settings.lazy_decommit);
+
+        arena.commit_page_count = page_index;
+    }
+}
+
+void Virtual_Arena::create(size_t bytesize, const Virtual_Arena_Settings& input_settings){
     assert(bytesize != 0u && BEEWAX_INTERNAL::vmemory_pagesize != 0u);
 
+    settings = input_settings;
     vbytesize = round_up_multiple(bytesize, BEEWAX_INTERNAL::vmemory_pagesize);
     commit_page_count = 0u;
     cursor = 0u;
 
 #if defined(PLATFORM_LINUX)
-    ENGINE_CHECK(vmemory = mmap(nullptr, vbytesize, PROT_NONE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0), "FAILED to mmap");
+    if(settings.huge_pages){
+        // NOTE(hugo): huge pages require an aligned range ; reserve more and trim the unaligned head and tail
+        vbytesize = round_up_multiple(vbytesize, huge_page_bytesize);
+        size_t reserve_bytesize = vbytesize + huge_page_bytesize;
+
+        void* reserved = mmap(nullptr, reserve_bytesize, PROT_NONE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+        ENGINE_CHECK(reserved != MAP_FAILED, "FAILED to mmap");
+
+        size_t head = align_offset_next((uintptr_t)reserved, huge_page_bytesize);
+        size_t tail = reserve_bytesize - head - vbytesize;
+        if(head) ENGINE_CHECK(munmap(reserved, head) == 0, "FAILED munmap");
+        if(tail) ENGINE_CHECK(munmap((u8*)reserved + head + vbytesize, tail) == 0, "FAILED munmap");
+        vmemory = (u8*)reserved + head;
+
+        // NOTE(hugo): best effort ie fails when transparent huge pages are disabled
+        madvise(vmemory, vbytesize, MADV_HUGEPAGE);
+
+    }else{
+        vmemory = mmap(nullptr, vbytesize, PROT_NONE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+        ENGINE_CHECK(vmemory != MAP_FAILED, "FAILED to mmap");
+    }
 #elif defined(PLATFORM_WINDOWS)
     ENGINE_CHECK(vmemory = VirtualAlloc(nullptr, vbytesize, MEM_RESERVE, PAGE_NOACCESS), "FAILED VirtualAlloc");
 #else
@@ -37,38 +101,13 @@ void Virtual_Arena::destroy(){
 }
 
 void Virtual_Arena::reset(){
-#if defined(PLATFORM_LINUX)
-    ENGINE_CHECK(mprotect(vmemory, commit_page_count * BEEWAX_INTERNAL::vmemory_pagesize, PROT_NONE) == 0, "FAILED mprotect");
-#elif defined(PLATFORM_WINDOWS)
-    ENGINE_CHECK(VirtualFree(vmemory, commit_page_count * BEEWAX_INTERNAL::vmemory_pagesize, MEM_DECOMMIT), "FAILED VirtualFree");
-#else
-    static_assert(false, "Virtual_Arena::reset() not implemented for this platform");
-#endif
-
-    commit_page_count = 0u;
+    BEEWAX_INTERNAL::virtual_arena_decommit(*this, settings.keep_page_count);
     cursor = 0u;
 }
 
 void Virtual_Arena::reset_to_cursor(){
-    size_t new_commit_bytesize = round_up_multiple(cursor, BEEWAX_INTERNAL::vmemory_pagesize);
-    size_t current_commit_bytesize = commit_page_count * BEEWAX_INTERNAL::vmemory_pagesize;
-
-    if(new_commit_bytesize != current_commit_bytesize){
-        assert(new_commit_bytesize < current_commit_bytesize);
-
-        void* base_vmemory = (void*)((u8*)vmemory + new_commit_bytesize);
-        size_t to_decommit = current_commit_bytesize - new_commit_bytesize;
-
-#if defined(PLATFORM_LINUX)
-        ENGINE_CHECK(mprotect(base_vmemory, to_decommit, PROT_NONE) == 0, "FAILED mprotect");
-#elif defined(PLATFORM_WINDOWS)
-        ENGINE_CHECK(VirtualFree(base_vmemory, to_decommit, MEM_DECOMMIT), "FAILED VirtualFree");
-#else
-        static_assert(false, "Virtual_Arena::reset() not implemented for this platform");
-#endif
-
-        commit_page_count = new_commit_bytesize / BEEWAX_INTERNAL::vmemory_pagesize;
-    }
+    size_t cursor_page_count = round_up_multiple(cursor, BEEWAX_INTERNAL::vmemory_pagesize) / BEEWAX_INTERNAL::vmemory_pagesize;
+    BEEWAX_INTERNAL::virtual_arena_decommit(*this, cursor_page_count + settings.keep_page_count);
 }
 
 Virtual_Arena_Memory Virtual_Arena::allocate(size_t bytesize, size_t alignment){
@@ -81,14 +120,7 @@ Virtual_Arena_Memory Virtual_Arena::allocate(size_t bytesize, size_t alignment){
     if(new_cursor > commit_bytesize){
         size_t to_commit = round_up_multiple(new_cursor - commit_bytesize, BEEWAX_INTERNAL::vmemory_pagesize);
         void* base_vmemory = (void*)((u8*)vmemory + commit_bytesize);
-
-#if defined(PLATFORM_LINUX)
-        ENGINE_CHECK(mprotect(base_vmemory, to_commit, PROT_READ | PROT_WRITE) == 0, "FAILED mprotect");
-#elif defined(PLATFORM_WINDOWS)
-        ENGINE_CHECK(VirtualAlloc(base_vmemory, to_commit, MEM_COMMIT, PAGE_READWRITE), "FAILED VirtualAlloc");
-#else
-        static_assert(false, "Virtual_Arena::allocate() not implemented for this platform");
-#endif
+        BEEWAX_INTERNAL::vmemory_commit(base_vmemory, to_commit);
 
         commit_page_count += to_commit / BEEWAX_INTERNAL::vmemory_pagesize;
     }
@@ -105,3 +137,254 @@ void Virtual_Arena::free(const Virtual_Arena_Memory& memory){
     assert(memory.previous_cursor < cursor);
     cursor = memory.previous_cursor;
 }
+
+size_t Virtual_Arena::committed_bytesize() const{
+    return commit_page_count * BEEWAX_INTERNAL::vmemory_pagesize;
+}
+
+size_t Virtual_Arena::resident_bytesize() const{
+#if defined(PLATFORM_LINUX)
+    // NOTE(hugo): committed pages are only resident once touched ; pages freed with MADV_FREE are resident until reclaimed
+    constexpr size_t batch_page_count = 1024u;
+    unsigned char residency[batch_page_count];
+
+    size_t resident_page_count = 0u;
+    for(size_t page_index = 0u; page_index < commit_page_count; page_index += batch_page_count){
+        size_t npages = min(batch_page_count, commit_page_count - page_index);
+        void* base_vmemory = (void*)((u8*)vmemory + page_index * BEEWAX_INTERNAL::vmemory_pagesize);
+        ENGINE_CHECK(mincore(base_vmemory, npages * BEEWAX_INTERNAL::vmemory_pagesize, residency) == 0, "FAILED mincore");
+
+        for(size_t ipage = 0u; ipage != npages; ++ipage) resident_page_count += residency[ipage] & 1u;
+    }
+    return resident_page_count * BEEWAX_INTERNAL::vmemory_pagesize;
+
+#elif defined(PLATFORM_WINDOWS)
+    // NOTE(hugo): decommit is immediate on Windows ie committed is an upper bound of resident
+    return committed_bytesize();
+
+#else
+    static_assert(false, "Virtual_Arena::resident_bytesize() not implemented for this platform");
+
+#endif
+}
+
+// ---- scratch
+
+Virtual_Arena& get_scratch_arena(){
+    Virtual_Arena& arena = BEEWAX_INTERNAL::scratch_arena;
+    if(!arena.vmemory) arena.create(scratch_arena_bytesize);
+    return arena;
+}
+
+void destroy_scratch_arena(){
+    Virtual_Arena& arena = BEEWAX_INTERNAL::scratch_arena;
+    if(arena.vmemory){
+        assert(arena.cursor == 0u);
+        arena.destroy();
+    }
+}
+
+Scratch_Scope::Scratch_Scope(){
+    arena = &get_scratch_arena();
+    cursor = arena->cursor;
+}
+
+Scratch_Scope::~Scratch_Scope(){
+    assert(arena->cursor >= cursor);
+    arena->cursor = cursor;
+}
+
+void* Scratch_Scope::allocate(size_t bytesize, size_t alignment){
+    return arena->allocate(bytesize, alignment).ptr;
+}
+
+// ---- frame allocator
+
+void Frame_Allocator::create(size_t region_bytesize){
+    regions[0u].create(region_bytesize);
+    regions[1u].create(region_bytesize);
+    current_region = 0u;
+
+    last_bytesize = 0u;
+    high_water = 0u;
+}
+
+void Frame_Allocator::destroy(){
+    regions[0u].destroy();
+    regions[1u].destroy();
+}
+
+void Frame_Allocator::new_frame(){
+    last_bytesize = regions[current_region].cursor;
+    high_water = max(high_water, last_bytesize);
+
+    // NOTE(hugo): the pages remain committed ie no syscall in steady state
+    current_region = 1u - current_region;
+    regions[current_region].cursor = 0u;
+}
+
+void* Frame_Allocator::allocate(size_t bytesize, size_t alignment){
+    return regions[current_region].allocate(bytesize, alignment).ptr;
+}
+
+size_t Frame_Allocator::last_frame_bytesize() const{
+    return last_bytesize;
+}
+
+size_t Frame_Allocator::high_water_bytesize() const{
+    return high_water;
+}
+
+// ---- block pool
+
+namespace BEEWAX_INTERNAL{
+    static inline Block_Slab& block_pool_slab(const Block_Pool& pool, u32 islab){
+        return ((Block_Slab*)pool.slab_arena.vmemory)[islab];
+    }
+
+    static inline u8* block_pool_slab_memory(const Block_Pool& pool, u32 islab){
+        return (u8*)pool.block_arena.vmemory + (size_t)islab * pool.slab_bytesize;
+    }
+
+    static void block_pool_link_available(Block_Pool& pool, u32 islab){
+        Block_Slab& slab = block_pool_slab(pool, islab);
+        slab.prev = block_slab_none;
+        slab.next = pool.available_head;
+        if(pool.available_head != block_slab_none) block_pool_slab(pool, pool.available_head).prev = islab;
+        pool.available_head = islab;
+    }
+
+    static void block_pool_unlink_available(Block_Pool& pool, u32 islab){
+        Block_Slab& slab = block_pool_slab(pool, islab);
+        if(slab.prev != block_slab_none)    block_pool_slab(pool, slab.prev).next = slab.next;
+        else                                pool.available_head = slab.next;
+        if(slab.next != block_slab_none)    block_pool_slab(pool, slab.next).prev = slab.prev;
+    }
+
+    // NOTE(hugo): recommits a released slab or appends a new one to the arena
+    static bool block_pool_add_slab(Block_Pool& pool){
+        u32 islab;
+        if(pool.released_head != block_slab_none){
+            islab = pool.released_head;
+            pool.released_head = block_pool_slab(pool, islab).next;
+            --pool.nreleased_slabs;
+
+            vmemory_commit(block_pool_slab_memory(pool, islab), pool.slab_bytesize);
+
+        }else{
+            if(pool.block_arena.cursor + pool.slab_bytesize > pool.block_arena.vbytesize) return false;
+
+            pool.block_arena.allocate(pool.slab_bytesize, 1u);
+            pool.slab_arena.allocate<Block_Slab>(1u);
+            islab = pool.nslabs++;
+        }
+
+        Block_Slab& slab = block_pool_slab(pool, islab);
+        slab.free_head = nullptr;
+        slab.nallocated = 0u;
+        slab.ninitialized = 0u;
+        slab.committed = true;
+        block_pool_link_available(pool, islab);
+
+        return true;
+    }
+}
+
+void Block_Pool::create(size_t block_bytesize, u32 requested_blocks_per_slab, size_t max_bytesize){
+    size_t pagesize = BEEWAX_INTERNAL::vmemory_pagesize;
+    assert(block_bytesize != 0u && requested_blocks_per_slab != 0u && pagesize != 0u);
+
+    size_t block_alignment = block_bytesize >= pagesize ? pagesize : cache_line_bytesize;
+    block_stride = round_up_multiple(max(block_bytesize, sizeof(void*)), block_alignment);
+
+    // NOTE(hugo): the padding up to the page size is used by additional blocks
+    slab_bytesize = round_up_multiple(block_stride * requested_blocks_per_slab, pagesize);
+    blocks_per_slab = (u32)(slab_bytesize / block_stride);
+
+    block_arena.create(max(max_bytesize, slab_bytesize));
+    slab_arena.create(max((size_t)1u, block_arena.vbytesize / slab_bytesize) * sizeof(BEEWAX_INTERNAL::Block_Slab));
+
+    nslabs = 0u;
+    nreleased_slabs = 0u;
+    available_head = BEEWAX_INTERNAL::block_slab_none;
+    released_head = BEEWAX_INTERNAL::block_slab_none;
+    nallocated = 0u;
+}
+
+void Block_Pool::destroy(){
+    block_arena.destroy();
+    slab_arena.destroy();
+}
+
+void* Block_Pool::allocate(){
+    if(available_head == BEEWAX_INTERNAL::block_slab_none && !BEEWAX_INTERNAL::block_pool_add_slab(*this)) return nullptr;
+
+    u32 islab = available_head;
+    BEEWAX_INTERNAL::Block_Slab& slab = BEEWAX_INTERNAL::block_pool_slab(*this, islab);
+
+    void* block;
+    if(slab.free_head){
+        block = slab.free_head;
+        slab.free_head = *(void**)block;
+    }else{
+        block = BEEWAX_INTERNAL::block_pool_slab_memory(*this, islab) + slab.ninitialized * block_stride;
+        ++slab.ninitialized;
+    }
+
+    ++slab.nallocated;
+    ++nallocated;
+    if(slab.nallocated == blocks_per_slab) BEEWAX_INTERNAL::block_pool_unlink_available(*this, islab);
+
+    return block;
+}
+
+void Block_Pool::free(void* block){
+    assert(contains(block));
+
+    u32 islab = (u32)(((u8*)block - (u8*)block_arena.vmemory) / slab_bytesize);
+    BEEWAX_INTERNAL::Block_Slab& slab = BEEWAX_INTERNAL::block_pool_slab(*this, islab);
+    assert(slab.committed && slab.nallocated != 0u);
+
+    *(void**)block = slab.free_head;
+    slab.free_head = block;
+
+    if(slab.nallocated == blocks_per_slab) BEEWAX_INTERNAL::block_pool_link_available(*this, islab);
+    --slab.nallocated;
+    --nallocated;
+}
+
+size_t Block_Pool::release_empty_slabs(size_t max_bytesize, u64 deadline_ticks){
+    size_t released_bytesize = 0u;
+
+    u32 islab = available_head;
+    while(islab != BEEWAX_INTERNAL::block_slab_none && released_bytesize + slab_bytesize <= max_bytesize){
+        if(deadline_ticks != UINT64_MAX && timer_ticks() >= deadline_ticks) break;
+
+        BEEWAX_INTERNAL::Block_Slab& slab = BEEWAX_INTERNAL::block_pool_slab(*this, islab);
+        u32 next_slab = slab.next;
+
+        if(!slab.nallocated){
+            BEEWAX_INTERNAL::block_pool_unlink_available(*this, islab);
+            BEEWAX_INTERNAL::vmemory_decommit(BEEWAX_INTERNAL::block_pool_slab_memory(*this, islab), slab_bytesize, false);
+
+            slab.committed = false;
+            slab.next = released_head;
+            released_head = islab;
+            ++nreleased_slabs;
+
+            released_bytesize += slab_bytesize;
+        }
+
+        islab = next_slab;
+    }
+
+    return released_bytesize;
+}
+
+bool Block_Pool::contains(const void* ptr) const{
+    return (const u8*)ptr >= (const u8*)block_arena.vmemory && (const u8*)ptr < (const u8*)block_arena.vmemory + block_arena.cursor;
+}
+
+size_t Block_Pool::committed_bytesize() const{
+    return (size_t)(nslabs - nreleased_slabs) * slab_bytesize;
+}
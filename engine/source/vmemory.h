@@ -11,10 +11,22 @@ struct Virtual_Arena_Memory{
     size_t previous_cursor = 0u;
 };
 
+// NOTE(hugo): huge_pages requests transparent huge pages on Linux ; ignored on Windows where large pages require a privilege
+constexpr size_t huge_page_bytesize = MEGABYTES(2u);
+
+struct Virtual_Arena_Settings{
+    // NOTE(hugo): pages kept committed after the cursor by reset() and reset_to_cursor() ie hysteresis against commit / decommit cycles
+    size_t keep_page_count = 0u;
+    // NOTE(hugo): MADV_FREE instead of MADV_DONTNEED on Linux ie the kernel reclaims the pages lazily under memory pressure
+    bool lazy_decommit = false;
+    bool huge_pages = false;
+};
+
 struct Virtual_Arena{
-    void create(size_t bytesize);
+    void create(size_t bytesize, const Virtual_Arena_Settings& settings = Virtual_Arena_Settings());
     void destroy();
 
+    // NOTE(hugo): the decommitted pages are returned to the OS
     void reset();
     void reset_to_cursor();
 
@@ -24,6 +36,10 @@ struct Virtual_Arena{
     template<typename T>
     Virtual_Arena_Memory allocate(u32 nT);
 
+    // NOTE(hugo): resident_bytesize() queries the OS ie not meant to be called every frame
+    size_t committed_bytesize() const;
+    size_t resident_bytesize() const;
+
     // ---- data
 
     void* vmemory;
@@ -31,10 +47,142 @@ struct Virtual_Arena{
 
     size_t commit_page_count;
     size_t cursor;
+
+    Virtual_Arena_Settings settings;
+};
+
+// ---- scratch
+
+// NOTE(hugo): one Virtual_Arena per thread for function scope temporary allocations
+// the memory is committed once and reused ie steady-state scopes do not allocate from the heap
+constexpr size_t scratch_arena_bytesize = MEGABYTES(512u);
+
+// NOTE(hugo): created on the first use by the calling thread
+Virtual_Arena& get_scratch_arena();
+// NOTE(hugo): must be called by a thread that used its scratch arena before exiting
+void destroy_scratch_arena();
+
+// NOTE(hugo): rewinds the scratch arena of the calling thread on exit ie the memory allocated in the scope is released
+// /!\ scopes must be nested /!\ memory must not escape the scope nor be used by another thread
+struct Scratch_Scope{
+    Scratch_Scope();
+    ~Scratch_Scope();
+
+    void* allocate(size_t bytesize, size_t alignment);
+
+    template<typename T>
+    T* allocate(u32 nT);
+
+    // ---- data
+
+    Virtual_Arena* arena;
+    size_t cursor;
+};
+
+// ---- frame allocator
+
+// NOTE(hugo): two regions used alternately ie the memory allocated during frame N remains valid during frame N + 1
+// new_frame() switches to the other region and rewinds it ; the memory of frame N - 1 is then released
+struct Frame_Allocator{
+    void create(size_t region_bytesize);
+    void destroy();
+
+    void new_frame();
+
+    void* allocate(size_t bytesize, size_t alignment);
+
+    template<typename T>
+    T* allocate(u32 nT);
+
+    // NOTE(hugo): bytesize allocated during the previous frame and the maximum over every frame
+    size_t last_frame_bytesize() const;
+    size_t high_water_bytesize() const;
+
+    // ---- data
+
+    Virtual_Arena regions[2u];
+    u32 current_region;
+
+    size_t last_bytesize;
+    size_t high_water;
+};
+
+// ---- block pool
+
+// NOTE(hugo): fixed-size blocks carved out of slabs of contiguous memory ie no per-block header
+// blocks are aligned on cache_line_bytesize and on the page size when larger than a page
+// a slab without allocated blocks can be returned to the OS by release_empty_slabs()
+constexpr size_t cache_line_bytesize = 64u;
+constexpr size_t block_pool_max_bytesize = GIGABYTES(16u);
+
+namespace BEEWAX_INTERNAL{
+    constexpr u32 block_slab_none = UINT32_MAX;
+
+    struct Block_Slab{
+        void* free_head;
+        u32 nallocated;
+        // NOTE(hugo): the blocks after ninitialized were never allocated ie the free list is built lazily
+        u32 ninitialized;
+
+        // NOTE(hugo): list of the committed slabs with available blocks or list of the released slabs
+        u32 next;
+        u32 prev;
+        bool committed;
+    };
+}
+
+struct Block_Pool{
+    void create(size_t block_bytesize, u32 blocks_per_slab, size_t max_bytesize = block_pool_max_bytesize);
+    void destroy();
+
+    // NOTE(hugo): returns nullptr when /max_bytesize/ is reached
+    void* allocate();
+    void free(void* block);
+
+    template<typename T>
+    T* allocate();
+
+    // NOTE(hugo): returns the bytesize released ; the slabs are released whole while within /max_bytesize/
+    // stops before the next slab once timer_ticks() reaches /deadline_ticks/
+    size_t release_empty_slabs(size_t max_bytesize = SIZE_MAX, u64 deadline_ticks = UINT64_MAX);
+
+    bool contains(const void* ptr) const;
+    size_t committed_bytesize() const;
+
+    // ---- data
+
+    Virtual_Arena block_arena;
+    Virtual_Arena slab_arena;
+
+    size_t block_stride;
+    size_t slab_bytesize;
+    u32 blocks_per_slab;
+
+    u32 nslabs;
+    u32 nreleased_slabs;
+    u32 available_head;
+    u32 released_head;
+    u32 nallocated;
 };
 
 // ----
 
+template<typename T>
+T* Block_Pool::allocate(){
+    assert(sizeof(T) <= block_stride);
+    return (T*)allocate();
+}
+
+template<typename T>
+T* Frame_Allocator::allocate(u32 nT){
+    return (T*)allocate(nT * sizeof(T), alignof(T));
+}
+
+template<typename T>
+T* Scratch_Scope::allocate(u32 nT){
+    return (T*)allocate(nT * sizeof(T), alignof(T));
+}
+
 template<typename T>
 Virtual_Arena_Memory Virtual_Arena::allocate(u32 nT){
     return allocate(nT * sizeof(T), alignof(T));
@@ -0,0 +1,96 @@
+namespace BEEWAX_INTERNAL{
+    static void worker_pool_consume_jobs(Worker_Pool_SDL* pool, u32 iworker){
+        u32 ijob = atomic_add<u32>(&pool->next_job, 1u);
+        while(ijob < pool->njobs){
+            pool->job(pool->job_data, ijob, iworker);
+            ijob = atomic_add<u32>(&pool->next_job, 1u);
+        }
+    }
+
+    static int worker_thread_SDL(void* data){
+        Worker_Context_SDL* context = (Worker_Context_SDL*)data;
+        Worker_Pool_SDL* pool = context->pool;
+
+        while(true){
+            SDL_CHECK(SDL_SemWait(pool->start_semaphore) == 0);
+            if(atomic_get<u32>(&pool->terminate)) break;
+
+            worker_pool_consume_jobs(pool, context->iworker);
+
+            SDL_CHECK(SDL_SemPost(pool->done_semaphore) == 0);
+        }
+
+        destroy_scratch_arena();
+
+        return 0;
+    }
+}
+
+void Worker_Pool_SDL::create(u32 requested_nworkers){
+    nworkers = requested_nworkers ? requested_nworkers : max(1u, detect_physical_cores());
+
+    start_semaphore = SDL_CreateSemaphore(0u);
+    SDL_CHECK(start_semaphore);
+    done_semaphore = SDL_CreateSemaphore(0u);
+    SDL_CHECK(done_semaphore);
+    terminate = 0u;
+
+    job = nullptr;
+    job_data = nullptr;
+    njobs = 0u;
+    next_job = 0u;
+
+    threads = nullptr;
+    contexts = nullptr;
+    if(nworkers > 1u){
+        threads = (SDL_Thread**)bw_malloc(sizeof(SDL_Thread*) * (nworkers - 1u));
+        contexts = (BEEWAX_INTERNAL::Worker_Context_SDL*)bw_malloc(sizeof(BEEWAX_INTERNAL::Worker_Context_SDL) * (nworkers - 1u));
+
+        for(u32 ithread = 0u; ithread != nworkers - 1u; ++ithread){
+            contexts[ithread].pool = this;
+            contexts[ithread].iworker = ithread + 1u;
+
+            threads[ithread] = SDL_CreateThread(BEEWAX_INTERNAL::worker_thread_SDL, "bw_worker", &contexts[ithread]);
+            SDL_CHECK(threads[ithread]);
+        }
+    }
+}
+
+void Worker_Pool_SDL::destroy(){
+    atomic_set<u32>(&terminate, 1u);
+    for(u32 ithread = 0u; ithread != nworkers - 1u; ++ithread){
+        SDL_CHECK(SDL_SemPost(start_semaphore) == 0);
+    }
+    for(u32 ithread = 0u; ithread != nworkers - 1u; ++ithread){
+        SDL_WaitThread(threads[ithread], nullptr);
+    }
+
+    bw_free(threads);
+    bw_free(contexts);
+
+    SDL_DestroySemaphore(start_semaphore);
+    SDL_DestroySemaphore(done_semaphore);
+}
+
+void Worker_Pool_SDL::execute(u32 input_njobs, Worker_Job input_job, void* input_data){
+    if(!input_njobs) return;
+
+    job = input_job;
+    job_data = input_data;
+    njobs = input_njobs;
+    atomic_set<u32>(&next_job, 0u);
+
+    // NOTE(hugo): no need to wake more threads than there are jobs
+    u32 nthreads = min(nworkers - 1u, input_njobs - 1u);
+
+    for(u32 ithread = 0u; ithread != nthreads; ++ithread){
+        SDL_CHECK(SDL_SemPost(start_semaphore) == 0);
+    }
+
+    BEEWAX_INTERNAL::worker_pool_consume_jobs(this, 0u);
+
+    // NOTE(hugo): join
+    for(u32 ithread = 0u; ithread != nthreads; ++ithread){
+        SDL_CHECK(SDL_SemWait(done_semaphore) == 0);
+    }
+}
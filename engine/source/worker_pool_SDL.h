@@ -0,0 +1,43 @@
+#ifndef H_WORKER_POOL
+#define H_WORKER_POOL
+
+// NOTE(hugo): job = function(data, ijob, iworker) with ijob in [0, njobs[ and iworker in [0, nworkers[
+typedef void (*Worker_Job)(void* data, u32 ijob, u32 iworker);
+
+struct Worker_Pool_SDL;
+
+namespace BEEWAX_INTERNAL{
+    struct Worker_Context_SDL{
+        Worker_Pool_SDL* pool;
+        u32 iworker;
+    };
+}
+
+struct Worker_Pool_SDL{
+    // NOTE(hugo): nworkers = 0u uses detect_physical_cores()
+    // the calling thread is worker 0 ie (nworkers - 1) threads are created
+    void create(u32 nworkers = 0u);
+    void destroy();
+
+    // NOTE(hugo): returns when all the jobs are done ; the calling thread executes jobs as well
+    // /!\ must not be called from a job /!\ the pool holds a single execution at a time
+    void execute(u32 njobs, Worker_Job job, void* data);
+
+    // ---- data
+
+    u32 nworkers;
+    SDL_Thread** threads;
+    BEEWAX_INTERNAL::Worker_Context_SDL* contexts;
+
+    SDL_sem* start_semaphore;
+    SDL_sem* done_semaphore;
+    volatile u32 terminate;
+
+    // NOTE(hugo): current execution
+    Worker_Job job;
+    void* job_data;
+    u32 njobs;
+    volatile u32 next_job;
+};
+
+#endif